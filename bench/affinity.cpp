@@ -0,0 +1,73 @@
+// This program measures handing the destruction of objects released on a
+// worker thread back to their owner thread, by wrapping each deleter in a
+// closure posted to a mutex-guarded queue, and by `ptr::make_shared_on`.
+//
+// usage: ptr_bench_affinity [objects]
+
+#include "bench.h"
+
+#include <ptr/affinity.h>
+#include <ptr/shared.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Resource {
+  std::uint64_t handle = 0;
+};
+
+// `PostQueue` is the hand-written alternative: a queue of closures.
+class PostQueue {
+  std::mutex mutex;
+  std::vector<std::function<void()>> tasks;
+
+ public:
+  void post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+
+  void drain() {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ready.swap(tasks);
+    }
+    for (auto& task : ready) {
+      task();
+    }
+  }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t objects = bench::arg(argc, argv, 1, 200'000);
+
+  PostQueue posts;
+  bench::report("deleter posting a closure", bench::seconds([&]() {
+    std::vector<ptr::Shared<Resource>> handles;
+    for (std::size_t i = 0; i < objects; ++i) {
+      handles.emplace_back(new Resource, [&posts](Resource *resource) {
+        posts.post([resource]() { delete resource; });
+      });
+    }
+    std::thread([&]() { handles.clear(); }).join();
+    posts.drain();
+  }), objects);
+
+  ptr::DestructionQueue queue;
+  bench::report("ptr::make_shared_on", bench::seconds([&]() {
+    std::vector<ptr::Shared<Resource>> handles;
+    for (std::size_t i = 0; i < objects; ++i) {
+      handles.push_back(ptr::make_shared_on<Resource>(queue));
+    }
+    std::thread([&]() { handles.clear(); }).join();
+    queue.drain();
+  }), objects);
+}
@@ -0,0 +1,58 @@
+// This program measures building and tearing down a small object graph per
+// request, with control blocks from the global heap and from a `ptr::Arena`
+// per request.
+//
+// usage: ptr_bench_arena [requests [nodes]]
+
+#include "bench.h"
+
+#include <ptr/arena.h>
+#include <ptr/shared.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+struct Node {
+  std::uint64_t value;
+  std::vector<ptr::Shared<Node>> children;
+
+  explicit Node(std::uint64_t value)
+  : value(value) {}
+};
+
+// Build a tree of `nodes` nodes in which each node's parent is at half its
+// index, using `make` to allocate them.
+template <typename Make>
+ptr::Shared<Node> build(std::size_t nodes, Make&& make) {
+  std::vector<ptr::Shared<Node>> all;
+  all.reserve(nodes);
+  for (std::size_t i = 0; i < nodes; ++i) {
+    all.push_back(make(i));
+    if (i) {
+      all[i / 2]->children.push_back(all[i]);
+    }
+  }
+  return all[0];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t requests = bench::arg(argc, argv, 1, 2'000);
+  const std::size_t nodes = bench::arg(argc, argv, 2, 500);
+
+  bench::report("ptr::make_shared per request", bench::seconds([&]() {
+    for (std::size_t request = 0; request < requests; ++request) {
+      build(nodes, [](std::size_t i) { return ptr::make_shared<Node>(i); });
+    }
+  }), requests * nodes);
+
+  bench::report("ptr::Arena::make_shared per request", bench::seconds([&]() {
+    for (std::size_t request = 0; request < requests; ++request) {
+      ptr::Arena arena;
+      build(nodes, [&](std::size_t i) { return arena.make_shared<Node>(i); });
+    }
+  }), requests * nodes);
+}
@@ -0,0 +1,38 @@
+// This program measures fanning out one object to many subscribers, as
+// vectors of `ptr::Shared`, on several threads at once. Copying and
+// destroying a `std::vector` costs one atomic operation per handle, all on the
+// same cache line; `ptr::SharedVector` costs one per distinct object.
+//
+// usage: ptr_bench_batch [threads [subscribers [rounds]]]
+
+#include "bench.h"
+
+#include <ptr/batch.h>
+#include <ptr/shared.h>
+
+#include <vector>
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t subscribers = bench::arg(argc, argv, 2, 10'000);
+  const std::size_t rounds = bench::arg(argc, argv, 3, 100);
+  const std::size_t handles = threads * subscribers * rounds;
+
+  auto message = ptr::make_shared<std::vector<char>>(1024);
+
+  bench::report("std::vector<ptr::Shared> fill, copy, destroy",
+                bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t round = 0; round < rounds; ++round) {
+      std::vector<ptr::Shared<std::vector<char>>> fan_out(subscribers, message);
+      std::vector<ptr::Shared<std::vector<char>>> copy = fan_out;
+    }
+  }), handles);
+
+  bench::report("ptr::SharedVector fill, copy, destroy",
+                bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t round = 0; round < rounds; ++round) {
+      ptr::SharedVector<std::vector<char>> fan_out(subscribers, message);
+      ptr::SharedVector<std::vector<char>> copy = fan_out;
+    }
+  }), handles);
+}
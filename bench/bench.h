@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+// These are helpers shared by the benchmark programs. Each program takes its
+// problem sizes as optional positional command line arguments, so that the
+// defaults can stay small enough to run under the sanitizers.
+namespace bench {
+
+// Return the positional command line argument at `index` as a number, or
+// return `fallback` if there is no such argument.
+inline std::size_t arg(int argc, char *argv[], int index, std::size_t fallback) {
+  if (index >= argc) {
+    return fallback;
+  }
+  return std::strtoull(argv[index], nullptr, 10);
+}
+
+// Return the number of seconds that it takes to call `body()`.
+template <typename Body>
+double seconds(Body&& body) {
+  const auto before = std::chrono::steady_clock::now();
+  std::forward<Body>(body)();
+  const auto after = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(after - before).count();
+}
+
+// Call `body(i)` on each of `threads` threads, where `i` is the index of the
+// thread, and return the number of seconds until all of the threads finish.
+template <typename Body>
+double seconds_on_threads(std::size_t threads, Body&& body) {
+  return seconds([&]() {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers.emplace_back([&body, i]() { body(i); });
+    }
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  });
+}
+
+// Print one line of results: the name of the measurement, the elapsed time,
+// and the resulting rate of `operations` per second.
+inline void report(const char *name, double seconds, std::size_t operations) {
+  std::printf("%-56s %10.4f s %14.0f ops/s\n", name, seconds,
+              operations / seconds);
+}
+
+// Return the resident set size of this process in bytes, or zero if it is
+// unknown.
+inline std::size_t resident_bytes() {
+  std::FILE *statm = std::fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  unsigned long long size = 0, resident = 0;
+  const int fields = std::fscanf(statm, "%llu %llu", &size, &resident);
+  std::fclose(statm);
+  return fields == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+} // namespace bench
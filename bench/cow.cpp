@@ -0,0 +1,63 @@
+// This program compares copying a large configuration object per request
+// "just in case" with copying a `ptr::Cow` of it, when only a small fraction
+// of requests modify their copy.
+//
+// usage: ptr_bench_cow [requests [one_in_n_mutates]]
+
+#include "bench.h"
+
+#include <ptr/cow.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Config {
+  std::map<std::string, std::string> settings;
+  std::vector<double> weights;
+};
+
+Config make_config() {
+  Config config;
+  for (int i = 0; i < 200; ++i) {
+    config.settings.emplace("setting." + std::to_string(i),
+                            std::string(32, char('a' + i % 26)));
+  }
+  config.weights.assign(4096, 0.5);
+  return config;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t requests = bench::arg(argc, argv, 1, 5'000);
+  const std::size_t one_in_n_mutates = bench::arg(argc, argv, 2, 100);
+
+  const Config config = make_config();
+  std::size_t checksum = 0;
+
+  bench::report("eager copy per request", bench::seconds([&]() {
+    for (std::size_t i = 0; i < requests; ++i) {
+      Config copy = config;
+      if (i % one_in_n_mutates == 0) {
+        copy.weights[i % copy.weights.size()] = 1.0;
+      }
+      checksum += copy.settings.size();
+    }
+  }), requests);
+
+  const ptr::Cow<Config> shared(config);
+  bench::report("ptr::Cow copy per request", bench::seconds([&]() {
+    for (std::size_t i = 0; i < requests; ++i) {
+      ptr::Cow<Config> copy = shared;
+      if (i % one_in_n_mutates == 0) {
+        copy.mutate().weights[i % copy->weights.size()] = 1.0;
+      }
+      checksum += copy->settings.size();
+    }
+  }), requests);
+
+  std::printf("checksum: %zu\n", checksum);
+}
@@ -0,0 +1,49 @@
+// This program measures a request loop that copies and drops handles to a
+// few hot objects, on several threads at once. With `ptr::Shared`, each copy
+// and each release is an atomic operation on a contended cache line; with
+// `ptr::LocalShared`, they adjust a thread-local count, and the control block
+// is touched once per object per `ptr::DeferredScope`.
+//
+// usage: ptr_bench_deferred [threads [requests [copies]]]
+
+#include "bench.h"
+
+#include <ptr/deferred.h>
+#include <ptr/shared.h>
+
+#include <vector>
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t requests = bench::arg(argc, argv, 2, 1'000);
+  const std::size_t copies = bench::arg(argc, argv, 3, 1'000);
+  const std::size_t operations = threads * requests * copies;
+
+  std::vector<ptr::Shared<int>> hot;
+  for (int i = 0; i < 4; ++i) {
+    hot.push_back(ptr::make_shared<int>(i));
+  }
+
+  bench::report("ptr::Shared copy and drop",
+                bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t request = 0; request < requests; ++request) {
+      for (std::size_t i = 0; i < copies; ++i) {
+        ptr::Shared<int> copy = hot[i % hot.size()];
+      }
+    }
+  }), operations);
+
+  bench::report("ptr::LocalShared copy and drop, flushed per request",
+                bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t request = 0; request < requests; ++request) {
+      ptr::DeferredScope scope;
+      std::vector<ptr::LocalShared<int>> local;
+      for (const ptr::Shared<int>& object : hot) {
+        local.emplace_back(object);
+      }
+      for (std::size_t i = 0; i < copies; ++i) {
+        ptr::LocalShared<int> copy = local[i % local.size()];
+      }
+    }
+  }), operations);
+}
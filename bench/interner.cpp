@@ -0,0 +1,69 @@
+// This program builds a table of `ptr::Shared` strings with many duplicates,
+// first giving each row its own `ptr::make_shared` copy and then interning
+// each row with a `ptr::Interner`, and reports the time and the memory that
+// the table holds each way. It then interns from several threads at once,
+// where nearly every call finds an existing instance.
+//
+// usage: ptr_bench_interner [rows [distinct [threads]]]
+
+#include "bench.h"
+
+#include <ptr/interner.h>
+#include <ptr/shared.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string symbol(std::size_t i, std::size_t distinct) {
+  // Long enough not to fit in the small string buffer.
+  return "namespace::module::symbol_" + std::to_string(i % distinct);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t rows = bench::arg(argc, argv, 1, 200'000);
+  const std::size_t distinct = bench::arg(argc, argv, 2, 1'000);
+  const std::size_t threads = bench::arg(argc, argv, 3, 4);
+
+  {
+    const std::size_t before = bench::resident_bytes();
+    std::vector<ptr::Shared<const std::string>> table;
+    table.reserve(rows);
+    bench::report("ptr::make_shared per row", bench::seconds([&]() {
+      for (std::size_t i = 0; i < rows; ++i) {
+        table.push_back(ptr::make_shared<const std::string>(symbol(i, distinct)));
+      }
+    }), rows);
+    std::printf("  resident growth: %zu KiB\n",
+                (bench::resident_bytes() - before) / 1024);
+  }
+
+  {
+    ptr::Interner<std::string> interner;
+    const std::size_t before = bench::resident_bytes();
+    std::vector<ptr::Shared<const std::string>> table;
+    table.reserve(rows);
+    bench::report("ptr::Interner::intern per row", bench::seconds([&]() {
+      for (std::size_t i = 0; i < rows; ++i) {
+        table.push_back(interner.intern(symbol(i, distinct)));
+      }
+    }), rows);
+    const ptr::InternerStats stats = interner.stats();
+    std::printf("  resident growth: %zu KiB, dedup ratio %.1f, "
+                "%zu KiB of control blocks saved\n",
+                (bench::resident_bytes() - before) / 1024, stats.dedup_ratio(),
+                stats.bytes_saved / 1024);
+
+    const std::size_t per_thread = rows / threads;
+    bench::report("ptr::Interner::intern, concurrent hits",
+                  bench::seconds_on_threads(threads, [&](std::size_t t) {
+      for (std::size_t i = 0; i < per_thread; ++i) {
+        interner.intern(symbol(t * per_thread + i, distinct));
+      }
+    }), per_thread * threads);
+  }
+}
@@ -0,0 +1,51 @@
+// This program measures the memory held by a weak cache of large objects
+// after every object has been dropped, with the objects allocated by
+// `ptr::make_shared`, whose storage lives until the last weak reference, and
+// by `ptr::make_shared_large`, whose storage is released with the object.
+//
+// usage: ptr_bench_large [objects]
+
+#include "bench.h"
+
+#include <ptr/large.h>
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Fill a weak cache with `objects` objects made by `make`, touching all of
+// their memory, drop the strong references, and report the resident set.
+template <typename Object, typename Make>
+void fill_cache(const char *name, std::size_t objects, Make&& make) {
+  const std::size_t before = bench::resident_bytes();
+  std::vector<ptr::Weak<Object>> cache;
+  bench::report(name, bench::seconds([&]() {
+    for (std::size_t i = 0; i < objects; ++i) {
+      ptr::Shared<Object> object = make();
+      std::memset(object.get(), 1, sizeof(Object));
+      cache.emplace_back(object);
+    }
+  }), objects);
+  const std::size_t after = bench::resident_bytes();
+  std::printf("  resident growth with only weak references left: %zu KiB\n",
+              after > before ? (after - before) / 1024 : 0);
+}
+
+struct Object {
+  char bytes[256 * 1024];
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t objects = bench::arg(argc, argv, 1, 200);
+
+  fill_cache<Object>("ptr::make_shared", objects,
+                     []() { return ptr::make_shared<Object>(); });
+  fill_cache<Object>("ptr::make_shared_large", objects,
+                     []() { return ptr::make_shared_large<Object>(); });
+}
@@ -0,0 +1,56 @@
+// This program measures reading a lazily created shared object from several
+// threads, where the object already exists, with the usual mutex-guarded
+// "create if missing" check and with `ptr::LazyShared::get`.
+//
+// usage: ptr_bench_lazy [reads_per_thread [threads]]
+
+#include "bench.h"
+
+#include <ptr/lazy.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+int main(int argc, char *argv[]) {
+  const std::size_t reads = bench::arg(argc, argv, 1, 1'000'000);
+  const std::size_t threads = bench::arg(argc, argv, 2, 4);
+  std::atomic<std::uint64_t> sink{0};
+
+  {
+    std::mutex mutex;
+    ptr::Shared<std::uint64_t> instance;
+    bench::report("mutex, check, copy ptr::Shared",
+                  bench::seconds_on_threads(threads, [&](std::size_t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i = 0; i < reads; ++i) {
+        ptr::Shared<std::uint64_t> service;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!instance.get()) {
+            instance = ptr::make_shared<std::uint64_t>(1);
+          }
+          service = instance;
+        }
+        sum += *service;
+      }
+      sink += sum;
+    }), reads * threads);
+  }
+
+  {
+    ptr::LazyShared<std::uint64_t> instance(
+      []() { return ptr::make_shared<std::uint64_t>(1); });
+    bench::report("ptr::LazyShared::get",
+                  bench::seconds_on_threads(threads, [&](std::size_t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i = 0; i < reads; ++i) {
+        sum += instance.get();
+      }
+      sink += sum;
+    }), reads * threads);
+  }
+
+  return sink == 2 * reads * threads ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+// This program measures false sharing between a thread that writes an object
+// and threads that copy and release handles to it, with the object allocated
+// by `ptr::make_shared`, which puts the ref counts on the same cache line as
+// the object, and by `ptr::make_shared_padded`, which does not.
+//
+// usage: ptr_bench_padded [copiers [iterations]]
+
+#include "bench.h"
+
+#include <ptr/padded.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace {
+
+struct Counter {
+  std::atomic<std::uint64_t> value{0};
+};
+
+void contend(const char *name, const ptr::Shared<Counter>& counter,
+             std::size_t copiers, std::size_t iterations) {
+  bench::report(name, bench::seconds_on_threads(copiers + 1, [&](std::size_t i) {
+    if (i == 0) {
+      for (std::size_t j = 0; j < iterations; ++j) {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+    for (std::size_t j = 0; j < iterations; ++j) {
+      ptr::Shared<Counter> copy = counter;
+    }
+  }), (copiers + 1) * iterations);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t copiers = bench::arg(argc, argv, 1, 3);
+  const std::size_t iterations = bench::arg(argc, argv, 2, 2'000'000);
+
+  contend("ptr::make_shared, counts beside object",
+          ptr::make_shared<Counter>(), copiers, iterations);
+  contend("ptr::make_shared_padded, counts on own cache line",
+          ptr::make_shared_padded<Counter>(), copiers, iterations);
+}
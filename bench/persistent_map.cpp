@@ -0,0 +1,69 @@
+// This program compares versioned key/value state kept in a
+// `ptr::PersistentMap` with the copy-on-write alternative: a shared
+// `std::unordered_map` that is copied whenever it is modified.
+//
+// usage: ptr_bench_persistent_map [elements [updates [lookups]]]
+
+#include "bench.h"
+
+#include <ptr/persistent_map.h>
+#include <ptr/shared.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+int main(int argc, char *argv[]) {
+  const std::size_t elements = bench::arg(argc, argv, 1, 100'000);
+  const std::size_t updates = bench::arg(argc, argv, 2, 50);
+  const std::size_t lookups = bench::arg(argc, argv, 3, 1'000'000);
+
+  using Table = std::unordered_map<std::uint64_t, std::uint64_t>;
+  auto table = ptr::make_shared<const Table>();
+  ptr::PersistentMap<std::uint64_t, std::uint64_t> map;
+
+  bench::report("build: std::unordered_map", bench::seconds([&]() {
+    Table draft;
+    for (std::size_t i = 0; i < elements; ++i) {
+      draft.emplace(i, i);
+    }
+    table = ptr::make_shared<const Table>(std::move(draft));
+  }), elements);
+
+  bench::report("build: ptr::PersistentMap::Transient", bench::seconds([&]() {
+    auto transient = map.transient();
+    for (std::size_t i = 0; i < elements; ++i) {
+      transient.set(i, i);
+    }
+    map = transient.persistent();
+  }), elements);
+
+  // Each update publishes a new version while readers may hold the old one.
+  bench::report("update: copy-on-write std::unordered_map", bench::seconds([&]() {
+    for (std::size_t i = 0; i < updates; ++i) {
+      auto copy = ptr::make_shared<Table>(*table);
+      (*copy)[(i * 7919) % elements] = i;
+      table = copy;
+    }
+  }), updates);
+
+  bench::report("update: ptr::PersistentMap::set", bench::seconds([&]() {
+    for (std::size_t i = 0; i < updates; ++i) {
+      map = map.set((i * 7919) % elements, i);
+    }
+  }), updates);
+
+  std::uint64_t checksum = 0;
+  bench::report("lookup: std::unordered_map", bench::seconds([&]() {
+    for (std::size_t i = 0; i < lookups; ++i) {
+      checksum += table->find((i * 31) % elements)->second;
+    }
+  }), lookups);
+
+  bench::report("lookup: ptr::PersistentMap", bench::seconds([&]() {
+    for (std::size_t i = 0; i < lookups; ++i) {
+      checksum += *map.find((i * 31) % elements);
+    }
+  }), lookups);
+
+  std::printf("checksum: %llu\n", static_cast<unsigned long long>(checksum));
+}
@@ -0,0 +1,75 @@
+// This program compares taking snapshots of a table by copying a
+// `std::vector` with taking them from a `ptr::PersistentVector`.
+// Each round modifies one element of the table and takes a snapshot for
+// readers.
+//
+// usage: ptr_bench_persistent_vector [elements [rounds]]
+
+#include "bench.h"
+
+#include <ptr/persistent_vector.h>
+
+#include <cstdint>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+  const std::size_t elements = bench::arg(argc, argv, 1, 100'000);
+  const std::size_t rounds = bench::arg(argc, argv, 2, 1'000);
+
+  std::vector<std::uint64_t> table(elements);
+  ptr::PersistentVector<std::uint64_t> persistent;
+  bench::report("build: ptr::PersistentVector::push_back", bench::seconds([&]() {
+    for (std::size_t i = 0; i < elements; ++i) {
+      persistent = persistent.push_back(i);
+    }
+  }), elements);
+
+  ptr::PersistentVector<std::uint64_t> built;
+  bench::report("build: ptr::PersistentVector::Transient", bench::seconds([&]() {
+    auto transient = built.transient();
+    for (std::size_t i = 0; i < elements; ++i) {
+      transient.push_back(i);
+    }
+    built = transient.persistent();
+  }), elements);
+
+  std::uint64_t checksum = 0;
+  bench::report("snapshot: copy std::vector", bench::seconds([&]() {
+    for (std::size_t round = 0; round < rounds; ++round) {
+      table[(round * 7919) % elements] = round;
+      std::vector<std::uint64_t> snapshot = table;
+      checksum += snapshot[round % elements];
+    }
+  }), rounds);
+
+  bench::report("snapshot: ptr::PersistentVector::set", bench::seconds([&]() {
+    for (std::size_t round = 0; round < rounds; ++round) {
+      persistent = persistent.set((round * 7919) % elements, round);
+      ptr::PersistentVector<std::uint64_t> snapshot = persistent;
+      checksum += snapshot[round % elements];
+    }
+  }), rounds);
+
+  bench::report("batch of updates: ptr::PersistentVector::Transient",
+                bench::seconds([&]() {
+    auto transient = persistent.transient();
+    for (std::size_t round = 0; round < rounds; ++round) {
+      transient.set((round * 7919) % elements, round);
+    }
+    persistent = transient.persistent();
+  }), rounds);
+
+  bench::report("read all: std::vector", bench::seconds([&]() {
+    for (std::uint64_t value : table) {
+      checksum += value;
+    }
+  }), elements);
+
+  bench::report("read all: ptr::PersistentVector", bench::seconds([&]() {
+    for (std::uint64_t value : persistent) {
+      checksum += value;
+    }
+  }), elements);
+
+  std::printf("checksum: %llu\n", static_cast<unsigned long long>(checksum));
+}
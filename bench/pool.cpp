@@ -0,0 +1,56 @@
+// This program measures allocating and releasing many small objects on
+// several threads, with control blocks from the global heap and from a
+// `ptr::Pool`, and reports the resident set size after each.
+//
+// usage: ptr_bench_pool [threads [live [rounds]]]
+
+#include "bench.h"
+
+#include <ptr/pool.h>
+#include <ptr/shared.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct Order {
+  std::uint64_t id;
+  std::uint64_t price;
+  std::uint32_t quantity;
+};
+
+// Keep `live` objects per thread, replacing each of them `rounds` times.
+template <typename Make>
+void churn(const char *name, std::size_t threads, std::size_t live,
+           std::size_t rounds, Make&& make) {
+  bench::report(name, bench::seconds_on_threads(threads, [&](std::size_t) {
+    std::vector<ptr::Shared<Order>> orders(live);
+    for (std::size_t round = 0; round < rounds; ++round) {
+      for (std::size_t i = 0; i < live; ++i) {
+        orders[i] = make(round, i);
+      }
+    }
+  }), threads * live * rounds);
+  std::printf("  resident: %zu KiB\n", bench::resident_bytes() / 1024);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t live = bench::arg(argc, argv, 2, 10'000);
+  const std::size_t rounds = bench::arg(argc, argv, 3, 50);
+
+  churn("ptr::make_shared", threads, live, rounds,
+        [](std::size_t round, std::size_t i) {
+    return ptr::make_shared<Order>(Order{i, round, 1});
+  });
+
+  ptr::Pool<Order> pool(1024);
+  churn("ptr::Pool::make_shared", threads, live, rounds,
+        [&](std::size_t round, std::size_t i) {
+    return pool.make_shared(Order{i, round, 1});
+  });
+}
@@ -0,0 +1,72 @@
+// This program measures readers on several threads fetching a shared
+// configuration that rarely changes: by copying a `ptr::Shared` from behind a
+// mutex on every read, and through a `thread_local`
+// `ptr::Publisher::Reader`. A writer publishes a new version every
+// `reads_per_version` reads of the first reader.
+//
+// usage: ptr_bench_publisher [reads_per_thread [threads [reads_per_version]]]
+
+#include "bench.h"
+
+#include <ptr/publisher.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace {
+
+struct Config {
+  std::uint64_t limit;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t reads = bench::arg(argc, argv, 1, 1'000'000);
+  const std::size_t threads = bench::arg(argc, argv, 2, 4);
+  const std::size_t reads_per_version = bench::arg(argc, argv, 3, 100'000);
+  std::atomic<std::uint64_t> sink{0};
+
+  {
+    std::mutex mutex;
+    ptr::Shared<Config> current = ptr::make_shared<Config>(Config{1});
+    bench::report("mutex, copy ptr::Shared",
+                  bench::seconds_on_threads(threads, [&](std::size_t t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i = 0; i < reads; ++i) {
+        if (t == 0 && i % reads_per_version == 0) {
+          auto next = ptr::make_shared<Config>(Config{1});
+          std::lock_guard<std::mutex> lock(mutex);
+          current = next;
+        }
+        ptr::Shared<Config> config;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          config = current;
+        }
+        sum += config->limit;
+      }
+      sink += sum;
+    }), reads * threads);
+  }
+
+  {
+    ptr::Publisher<Config> publisher(ptr::make_shared<Config>(Config{1}));
+    bench::report("ptr::Publisher::Reader, thread_local",
+                  bench::seconds_on_threads(threads, [&](std::size_t t) {
+      thread_local ptr::Publisher<Config>::Reader reader(publisher);
+      std::uint64_t sum = 0;
+      for (std::size_t i = 0; i < reads; ++i) {
+        if (t == 0 && i % reads_per_version == 0) {
+          publisher.publish(ptr::make_shared<Config>(Config{1}));
+        }
+        sum += reader->limit;
+      }
+      sink += sum;
+    }), reads * threads);
+  }
+
+  return sink == 2 * reads * threads ? 0 : 1;
+}
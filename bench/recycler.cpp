@@ -0,0 +1,53 @@
+// This program measures building and discarding messages whose buffers
+// reserve a large capacity, constructing each one with `ptr::make_shared`,
+// and reusing them through a `ptr::Recycler`.
+//
+// usage: ptr_bench_recycler [threads [messages [capacity]]]
+
+#include "bench.h"
+
+#include <ptr/recycler.h>
+#include <ptr/shared.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct Message {
+  std::vector<char> payload;
+
+  explicit Message(std::size_t capacity) {
+    payload.reserve(capacity);
+  }
+};
+
+struct Clear {
+  void operator()(Message& message) const {
+    message.payload.clear();
+  }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t messages = bench::arg(argc, argv, 2, 20'000);
+  const std::size_t capacity = bench::arg(argc, argv, 3, 64 * 1024);
+
+  bench::report("ptr::make_shared", bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t i = 0; i < messages; ++i) {
+      auto message = ptr::make_shared<Message>(capacity);
+      message->payload.push_back('x');
+    }
+  }), threads * messages);
+
+  ptr::Recycler<Message, Clear> recycler(threads * 2);
+  bench::report("ptr::Recycler::acquire_or_construct", bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t i = 0; i < messages; ++i) {
+      auto message = recycler.acquire_or_construct(capacity);
+      message->payload.push_back('x');
+    }
+  }), threads * messages);
+  std::printf("  %zu hits, %zu misses\n", recycler.hits(), recycler.misses());
+}
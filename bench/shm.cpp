@@ -0,0 +1,107 @@
+// This program measures passing large immutable buffers to another process,
+// either by copying their bytes through a socket or by sending the offset of
+// a `ptr::shm::Shared` in a region that both processes map.
+//
+// usage: ptr_bench_shm [messages [bytes]]
+
+#include "bench.h"
+
+#include <ptr/shm.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+void read_fully(int file, void *buffer, std::size_t bytes) {
+  char *out = static_cast<char*>(buffer);
+  while (bytes) {
+    const ssize_t got = read(file, out, bytes);
+    if (got <= 0) {
+      std::exit(1);
+    }
+    out += got;
+    bytes -= got;
+  }
+}
+
+void write_fully(int file, const void *buffer, std::size_t bytes) {
+  const char *in = static_cast<const char*>(buffer);
+  while (bytes) {
+    const ssize_t put = write(file, in, bytes);
+    if (put <= 0) {
+      std::exit(1);
+    }
+    in += put;
+    bytes -= put;
+  }
+}
+
+// Run `consume(socket)` in a child process, and `produce(socket)` in this
+// one, and return the number of seconds until both finish.
+template <typename Produce, typename Consume>
+double seconds_across_processes(Produce&& produce, Consume&& consume) {
+  int sockets[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == -1) {
+    std::exit(1);
+  }
+  return bench::seconds([&]() {
+    const pid_t child = fork();
+    if (child == 0) {
+      close(sockets[0]);
+      consume(sockets[1]);
+      _exit(0);
+    }
+    close(sockets[1]);
+    produce(sockets[0]);
+    close(sockets[0]);
+    waitpid(child, nullptr, 0);
+  });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t messages = bench::arg(argc, argv, 1, 200);
+  const std::size_t bytes = bench::arg(argc, argv, 2, 1 << 20);
+  char ack = 0;
+
+  bench::report("copy buffer through socket",
+                seconds_across_processes([&](int socket) {
+    std::vector<char> buffer(bytes, 'x');
+    for (std::size_t i = 0; i < messages; ++i) {
+      write_fully(socket, buffer.data(), bytes);
+      read_fully(socket, &ack, 1);
+    }
+  }, [&](int socket) {
+    std::vector<char> buffer(bytes);
+    for (std::size_t i = 0; i < messages; ++i) {
+      read_fully(socket, buffer.data(), bytes);
+      write_fully(socket, &ack, 1);
+    }
+  }), messages);
+
+  auto region = ptr::shm::Region::create(2 * bytes + 4096);
+  bench::report("send ptr::shm::Shared offset through socket",
+                seconds_across_processes([&](int socket) {
+    auto buffer = ptr::shm::make_shared_array<char>(region, bytes);
+    for (std::size_t i = 0; i < messages; ++i) {
+      ptr::shm::Offset offset = ptr::shm::Shared<char>(buffer).release();
+      write_fully(socket, &offset, sizeof offset);
+      read_fully(socket, &ack, 1);
+    }
+  }, [&](int socket) {
+    auto mapping = ptr::shm::Region::open(dup(region.fd()));
+    for (std::size_t i = 0; i < messages; ++i) {
+      ptr::shm::Offset offset;
+      read_fully(socket, &offset, sizeof offset);
+      auto buffer = ptr::shm::Shared<const char>::adopt(mapping, offset);
+      write_fully(socket, &ack, 1);
+    }
+  }), messages);
+}
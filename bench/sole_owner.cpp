@@ -0,0 +1,28 @@
+// This program measures adopting a raw pointer into a `ptr::Shared` and
+// dropping it, which allocates no control block, against doing the same with
+// one copy in between, which does.
+//
+// usage: ptr_bench_sole_owner [iterations]
+
+#include "bench.h"
+
+#include <ptr/shared.h>
+
+#include <cstdint>
+
+int main(int argc, char *argv[]) {
+  const std::size_t iterations = bench::arg(argc, argv, 1, 1'000'000);
+
+  bench::report("ptr::Shared(new T), dropped", bench::seconds([&]() {
+    for (std::size_t i = 0; i < iterations; ++i) {
+      ptr::Shared<std::uint64_t> owner(new std::uint64_t(i));
+    }
+  }), iterations);
+
+  bench::report("ptr::Shared(new T), copied once, dropped", bench::seconds([&]() {
+    for (std::size_t i = 0; i < iterations; ++i) {
+      ptr::Shared<std::uint64_t> owner(new std::uint64_t(i));
+      ptr::Shared<std::uint64_t> copy = owner;
+    }
+  }), iterations);
+}
@@ -0,0 +1,40 @@
+// This program measures releasing the last reference to objects made by
+// `ptr::make_shared`, whose control block declares the object dead and
+// juggles a weak reference on the way out, against objects made by
+// `ptr::make_shared_strong_only`, whose control block is a single count.
+// Only the releases are timed, not the allocations.
+//
+// usage: ptr_bench_strong [objects]
+
+#include "bench.h"
+
+#include <ptr/shared.h>
+#include <ptr/strong.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+template <typename Handle, typename Make>
+void release_last(const char *name, std::size_t objects, Make&& make) {
+  std::vector<Handle> handles;
+  handles.reserve(objects);
+  for (std::size_t i = 0; i < objects; ++i) {
+    handles.push_back(make(i));
+  }
+  bench::report(name, bench::seconds([&]() { handles.clear(); }), objects);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t objects = bench::arg(argc, argv, 1, 1'000'000);
+
+  release_last<ptr::Shared<std::uint64_t>>(
+    "ptr::make_shared, last release", objects,
+    [](std::size_t i) { return ptr::make_shared<std::uint64_t>(i); });
+  release_last<ptr::StrongShared<std::uint64_t>>(
+    "ptr::make_shared_strong_only, last release", objects,
+    [](std::size_t i) { return ptr::make_shared_strong_only<std::uint64_t>(i); });
+}
@@ -0,0 +1,55 @@
+// This program measures tearing down a large binary tree by dropping its root
+// on the calling thread, and by releasing it to `ptr::TeardownPool`s of
+// increasing size. A 100 million node tree is depth 26.
+//
+// usage: ptr_bench_teardown [depth [max_threads]]
+
+#include "bench.h"
+
+#include <ptr/shared.h>
+#include <ptr/teardown.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+struct Node {
+  std::uint64_t value = 0;
+  ptr::Shared<Node> left;
+  ptr::Shared<Node> right;
+};
+
+ptr::Shared<Node> tree(std::size_t depth) {
+  auto node = ptr::make_shared_teardown<Node>();
+  if (depth > 0) {
+    node->left = tree(depth - 1);
+    node->right = tree(depth - 1);
+  }
+  return node;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t depth = bench::arg(argc, argv, 1, 17);
+  const std::size_t max_threads = bench::arg(argc, argv, 2, 4);
+  const std::size_t nodes = (std::size_t(1) << (depth + 1)) - 1;
+
+  auto root = tree(depth);
+  bench::report("drop root on calling thread", bench::seconds([&]() {
+    root.reset();
+  }), nodes);
+
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    ptr::TeardownPool pool(threads);
+    root = tree(depth);
+    const std::string name =
+      "ptr::TeardownPool with " + std::to_string(threads) + " threads";
+    bench::report(name.c_str(), bench::seconds([&]() {
+      pool.release(std::move(root));
+      pool.wait();
+    }), nodes);
+  }
+}
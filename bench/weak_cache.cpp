@@ -0,0 +1,104 @@
+// This program measures the throughput of `ptr::WeakCache::get_or_create`
+// against the approach that it replaces: one mutex around a map of
+// `ptr::Weak`, with dead entries swept periodically.
+//
+// usage: ptr_bench_weak_cache [threads [operations_per_thread [keys]]]
+
+#include "bench.h"
+
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+#include <ptr/weak_cache.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+struct Value {
+  std::uint64_t id;
+  std::string payload;
+};
+
+Value make_value(std::uint64_t id) {
+  return Value{id, std::string(64, 'x')};
+}
+
+// `LockedWeakMap` is the baseline: every lookup takes the same mutex, and
+// expired entries are swept every `sweep_interval` insertions.
+class LockedWeakMap {
+  std::mutex mutex;
+  std::unordered_map<std::uint64_t, ptr::Weak<Value>> entries;
+  std::size_t insertions = 0;
+  static constexpr std::size_t sweep_interval = 1024;
+
+ public:
+  ptr::Shared<Value> get_or_create(std::uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ptr::Weak<Value>& entry = entries[key];
+    if (ptr::Shared<Value> value = entry.lock(); value.get()) {
+      return value;
+    }
+    auto value = ptr::make_shared<Value>(make_value(key));
+    entry = value;
+    if (++insertions % sweep_interval == 0) {
+      for (auto iter = entries.begin(); iter != entries.end();) {
+        if (iter->second.lock().get()) {
+          ++iter;
+        } else {
+          iter = entries.erase(iter);
+        }
+      }
+    }
+    return value;
+  }
+};
+
+// Each thread walks a pseudo-random sequence of keys, and keeps the most
+// recent `retained` values alive, so that a mix of hits, misses, and expiries
+// reaches the cache.
+template <typename Cache>
+double run(Cache& cache, std::size_t threads, std::size_t operations,
+           std::size_t keys) {
+  constexpr std::size_t retained = 16;
+  return bench::seconds_on_threads(threads, [&](std::size_t thread) {
+    std::vector<ptr::Shared<Value>> recent(retained);
+    std::uint64_t state = 0x9e3779b97f4a7c15ull * (thread + 1);
+    for (std::size_t i = 0; i < operations; ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      recent[i % retained] = cache.get_or_create(state % keys);
+    }
+  });
+}
+
+struct WeakCacheAdapter {
+  ptr::WeakCache<std::uint64_t, Value> cache;
+
+  ptr::Shared<Value> get_or_create(std::uint64_t key) {
+    return cache.get_or_create(key, [key]() { return make_value(key); });
+  }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t operations = bench::arg(argc, argv, 2, 200'000);
+  const std::size_t keys = bench::arg(argc, argv, 3, 4096);
+  const std::size_t total = threads * operations;
+
+  {
+    LockedWeakMap cache;
+    bench::report("mutex + map of ptr::Weak + sweeping",
+                  run(cache, threads, operations, keys), total);
+  }
+  {
+    WeakCacheAdapter cache;
+    bench::report("ptr::WeakCache",
+                  run(cache, threads, operations, keys), total);
+  }
+}
@@ -0,0 +1,75 @@
+// This program measures `ptr::Weak::lock` when many threads lock the same
+// `ptr::Weak` at once, both while the object is alive and after it has died.
+// The baseline is the compare-and-swap loop that `lock` used to be.
+//
+// usage: ptr_bench_weak_lock [threads [locks_per_thread]]
+
+#include "bench.h"
+
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+// This is the previous implementation of "increment if not zero," including
+// its habit of writing back an unchanged count when the object is dead.
+bool cas_loop_lock(ptr::ControlBlock& control_block) {
+  std::uint64_t expected = control_block.ref_counts.load();
+  ptr::RefCounts desired;
+  do {
+    desired = ptr::RefCounts::from_word(expected);
+    if (desired.strong_count()) {
+      ++desired.strong;
+    }
+  } while (!control_block.ref_counts.compare_exchange_weak(expected, desired.as_word()));
+  return desired.strong_count() != 0;
+}
+
+template <typename Lock>
+void run(const char *name, const ptr::Weak<std::string>& weak,
+         std::size_t threads, std::size_t locks, Lock&& lock) {
+  ptr::ControlBlock& control_block = *ptr::HandleAccess::control_block(weak);
+  const double seconds = bench::seconds_on_threads(threads, [&](std::size_t) {
+    for (std::size_t i = 0; i < locks; ++i) {
+      if (lock(weak, control_block)) {
+        control_block.decrement_strong();
+      }
+    }
+  });
+  bench::report(name, seconds, threads * locks);
+}
+
+bool sticky_lock(const ptr::Weak<std::string>&, ptr::ControlBlock& control_block) {
+  return control_block.try_increment_strong();
+}
+
+bool old_lock(const ptr::Weak<std::string>&, ptr::ControlBlock& control_block) {
+  return cas_loop_lock(control_block);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t threads = bench::arg(argc, argv, 1, 4);
+  const std::size_t locks = bench::arg(argc, argv, 2, 1'000'000);
+
+  auto object = ptr::make_shared<std::string>("alive");
+  ptr::Weak<std::string> weak{object};
+
+  run("alive: compare-and-swap loop", weak, threads, locks, old_lock);
+  run("alive: fetch_add with sticky zero", weak, threads, locks, sticky_lock);
+  run("alive: ptr::Weak::lock", weak, threads, locks,
+      [](const ptr::Weak<std::string>& weak, ptr::ControlBlock&) {
+        // The returned `ptr::Shared` releases its own reference.
+        weak.lock();
+        return false;
+      });
+
+  object.reset();
+
+  run("dead: compare-and-swap loop", weak, threads, locks, old_lock);
+  run("dead: fetch_add with sticky zero", weak, threads, locks, sticky_lock);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace ptr {
+
+// `DestructionQueue` is where objects created by `ptr::make_shared_on` go to
+// be destroyed on their owner thread. Typically each event loop thread has
+// one, and drains it on every turn of the loop.
+// When the last strong reference to such an object is released on the owner
+// thread, the object is destroyed right away. When it is released on any
+// other thread, its control block is pushed onto the queue instead, which is
+// lock-free and allocates nothing, since the control block is its own queue
+// node. The owner thread destroys the queued objects in `drain`.
+// The queue must outlive the objects created on it.
+class DestructionQueue;
+
+// Return a `ptr::Shared` to a new `Object` constructed from `args`, which
+// will be destroyed on the thread that owns `queue`.
+template <typename Object, typename... Args>
+Shared<Object> make_shared_on(DestructionQueue& queue, Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `DestructionLink` is the part of a control block that is a node of a
+// `DestructionQueue`.
+struct DestructionLink {
+  DestructionLink *next = nullptr;
+
+  // Destroy the object and release the control block's expiry weak
+  // reference, which may free the control block.
+  virtual void finish_expiry() = 0;
+
+ protected:
+  ~DestructionLink() = default;
+};
+
+} // namespace detail
+
+class DestructionQueue {
+  std::atomic<detail::DestructionLink*> pending{nullptr};
+  const std::thread::id owner;
+  const std::function<void()> wake;
+
+ public:
+  // Make the calling thread the owner. If `wake` is not empty, it is called,
+  // on the releasing thread, whenever an object is queued while the queue is
+  // empty, so that the owner's event loop can schedule a `drain`.
+  explicit DestructionQueue(std::function<void()> wake = {});
+  DestructionQueue(const DestructionQueue&) = delete;
+  DestructionQueue& operator=(const DestructionQueue&) = delete;
+  // Destroy the queued objects, on whatever thread this is.
+  ~DestructionQueue();
+
+  // Destroy the queued objects, in the order in which they were queued, and
+  // return how many there were. Only the owner thread may call `drain`.
+  std::size_t drain();
+
+  // Return whether there are no queued objects. The result is immediately
+  // stale if objects are being released concurrently.
+  bool empty() const;
+
+  // Return whether the calling thread is the owner.
+  bool on_owner_thread() const;
+
+  // Queue the destruction of `link`'s object.
+  void push(detail::DestructionLink *link);
+};
+
+// `AffineControlBlock` is an `InPlaceControlBlock` whose object is destroyed
+// on the thread that owns its `DestructionQueue`.
+template <typename Object>
+struct AffineControlBlock : public InPlaceControlBlock<Object>,
+                            public detail::DestructionLink {
+  DestructionQueue *queue;
+
+  AffineControlBlock(RefCounts counts, DestructionQueue *queue)
+  : InPlaceControlBlock<Object>(counts)
+  , queue(queue) {}
+
+  void expire() override {
+    if (queue->on_owner_thread()) {
+      InPlaceControlBlock<Object>::expire();
+    } else {
+      queue->push(this);
+    }
+  }
+
+  void finish_expiry() override {
+    InPlaceControlBlock<Object>::expire();
+  }
+};
+
+inline DestructionQueue::DestructionQueue(std::function<void()> wake)
+: owner(std::this_thread::get_id())
+, wake(std::move(wake)) {}
+
+inline DestructionQueue::~DestructionQueue() {
+  while (!empty()) {
+    drain();
+  }
+}
+
+inline std::size_t DestructionQueue::drain() {
+  // Reverse the stack to get the order of release.
+  detail::DestructionLink *link = pending.exchange(nullptr, std::memory_order_acquire);
+  detail::DestructionLink *ordered = nullptr;
+  while (link) {
+    detail::DestructionLink *next = link->next;
+    link->next = ordered;
+    ordered = link;
+    link = next;
+  }
+  // Read `next` before finishing, because that might free the link.
+  std::size_t count = 0;
+  while (ordered) {
+    std::exchange(ordered, ordered->next)->finish_expiry();
+    ++count;
+  }
+  return count;
+}
+
+inline bool DestructionQueue::empty() const {
+  return pending.load(std::memory_order_relaxed) == nullptr;
+}
+
+inline bool DestructionQueue::on_owner_thread() const {
+  return std::this_thread::get_id() == owner;
+}
+
+inline void DestructionQueue::push(detail::DestructionLink *link) {
+  detail::DestructionLink *head = pending.load(std::memory_order_relaxed);
+  do {
+    link->next = head;
+  } while (!pending.compare_exchange_weak(head, link,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+  // Once published, `link` may be drained and freed at any moment, so don't
+  // look at it again.
+  if (!head && wake) {
+    wake();
+  }
+}
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared_on(DestructionQueue& queue, Args&&... args) {
+  auto control_block = std::make_unique<AffineControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0}, &queue);
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return HandleAccess::adopt(object, control_block.release());
+}
+
+} // namespace ptr
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `Arena` is a `ptr::make_shared` for object graphs that are built and then
+// discarded all at once, such as those of a request. Its control blocks are
+// carved one after another from large chunks, and releasing a block frees
+// nothing: the object's destructor runs when its strong references are gone,
+// as usual, but the memory is reclaimed only when the `Arena` and every block
+// allocated from it are gone.
+// One thread at a time may allocate from an `Arena`. Handles to its objects
+// may be used and released on any thread, and may outlive the `Arena`.
+class Arena;
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `ArenaState` is the part of an `Arena` that lives as long as the arena or
+// any of its blocks.
+class ArenaState {
+  // `references` is one for the `Arena` plus one for each block.
+  std::atomic<std::size_t> references{1};
+  const std::size_t chunk_size;
+  std::vector<void*> chunks;
+  char *next = nullptr;
+  char *end = nullptr;
+  std::size_t allocated = 0;
+
+ public:
+  explicit ArenaState(std::size_t chunk_size)
+  : chunk_size(chunk_size) {}
+
+  ArenaState(const ArenaState&) = delete;
+  ArenaState& operator=(const ArenaState&) = delete;
+
+  ~ArenaState() {
+    for (void *chunk : chunks) {
+      ::operator delete(chunk);
+    }
+  }
+
+  void *allocate(std::size_t size, std::size_t align) {
+    std::size_t space = end - next;
+    void *memory = next;
+    if (!std::align(align, size, memory, space)) {
+      // Start a new chunk. Anything too big for a chunk gets its own.
+      const std::size_t bytes = std::max(chunk_size, size + align);
+      chunks.reserve(chunks.size() + 1);
+      next = static_cast<char*>(::operator new(bytes));
+      end = next + bytes;
+      chunks.push_back(next);
+      space = bytes;
+      memory = next;
+      std::align(align, size, memory, space);
+    }
+    next = static_cast<char*>(memory) + size;
+    allocated += size;
+    references.fetch_add(1, std::memory_order_relaxed);
+    return memory;
+  }
+
+  void release() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  std::size_t bytes_allocated() const {
+    return allocated;
+  }
+};
+
+template <typename Object>
+struct ArenaControlBlock : public InPlaceControlBlock<Object> {
+  ArenaState *arena;
+
+  ArenaControlBlock(RefCounts counts, ArenaState *arena)
+  : InPlaceControlBlock<Object>(counts)
+  , arena(arena) {}
+
+  void release_storage() override {
+    ArenaState *owner = arena;
+    this->~ArenaControlBlock();
+    owner->release();
+  }
+};
+
+} // namespace detail
+
+class Arena {
+  detail::ArenaState *state;
+
+ public:
+  // Allocate memory from the system `chunk_size` bytes at a time.
+  explicit Arena(std::size_t chunk_size = 64 * 1024);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena();
+
+  // Return a handle to a new `Object` constructed from `args`, whose control
+  // block is in this arena.
+  template <typename Object, typename... Args>
+  Shared<Object> make_shared(Args&&... args);
+
+  // Return the number of bytes of control blocks allocated so far.
+  std::size_t bytes_allocated() const;
+};
+
+inline Arena::Arena(std::size_t chunk_size)
+: state(new detail::ArenaState(chunk_size)) {}
+
+inline Arena::~Arena() {
+  state->release();
+}
+
+template <typename Object, typename... Args>
+Shared<Object> Arena::make_shared(Args&&... args) {
+  using Block = detail::ArenaControlBlock<Object>;
+  auto *control_block = new (state->allocate(sizeof(Block), alignof(Block)))
+    Block(RefCounts{.strong = 1, .weak = 0}, state);
+  Object *object;
+  try {
+    object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  } catch (...) {
+    control_block->release_storage();
+    throw;
+  }
+  return HandleAccess::adopt(object, control_block);
+}
+
+inline std::size_t Arena::bytes_allocated() const {
+  return state->bytes_allocated();
+}
+
+} // namespace ptr
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// These operations copy and release many `ptr::Shared` at once, with one
+// atomic read-modify-write per distinct control block rather than one per
+// handle. That matters most when many of the handles share a control block,
+// as when one object is fanned out to thousands of subscribers, because then
+// every one of those atomic operations would contend for the same cache line.
+
+// Assign to `*out++` a copy of each of the `count` handles beginning at
+// `first`, and return the resulting `out`.
+template <typename ForwardIter, typename OutputIter>
+OutputIter copy_n_shared(ForwardIter first, std::size_t count, OutputIter out);
+
+// Release the strong references of the `count` handles beginning at `first`,
+// leaving each of them empty. Objects whose last reference is among them are
+// destroyed, in no particular order.
+template <typename ForwardIter>
+void destroy_n_shared(ForwardIter first, std::size_t count);
+
+// `SharedVector` is a sequence of `ptr::Shared` that copies, fills, and
+// releases its elements in batches, as `ptr::copy_n_shared` and
+// `ptr::destroy_n_shared` do.
+template <typename Object>
+class SharedVector {
+  std::vector<Shared<Object>> handles;
+
+ public:
+  using value_type = Shared<Object>;
+  using const_iterator = typename std::vector<Shared<Object>>::const_iterator;
+
+  SharedVector() = default;
+  // Fill with `count` copies of `handle`, which costs one atomic operation.
+  SharedVector(std::size_t count, const Shared<Object>& handle);
+  SharedVector(const SharedVector&);
+  SharedVector(SharedVector&&) = default;
+  ~SharedVector();
+
+  SharedVector& operator=(const SharedVector&);
+  SharedVector& operator=(SharedVector&&);
+
+  std::size_t size() const;
+  bool empty() const;
+  const Shared<Object>& operator[](std::size_t index) const;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  void reserve(std::size_t capacity);
+  void push_back(const Shared<Object>& handle);
+  void push_back(Shared<Object>&& handle);
+  // Append `count` copies of `handle`, which costs one atomic operation.
+  void append(std::size_t count, const Shared<Object>& handle);
+  void clear();
+};
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `RefCountBatch` accumulates references to control blocks, and then
+// increments or decrements each distinct control block once, by the number
+// of times that it was added.
+class RefCountBatch {
+  // Consecutive additions of the same control block, which is the common
+  // case for fan-out, are coalesced as they arrive. The rest are merged by
+  // sorting when the batch is applied.
+  std::vector<std::pair<ControlBlock*, std::uint32_t>> counts;
+
+  void merge() {
+    if (counts.size() < 2) {
+      return;
+    }
+    // Built-in `<` doesn't order pointers into unrelated allocations, but
+    // `std::less` does.
+    std::sort(counts.begin(), counts.end(), [](const auto& left, const auto& right) {
+      return std::less<ControlBlock*>{}(left.first, right.first);
+    });
+    auto merged = counts.begin();
+    for (auto iter = counts.begin() + 1; iter != counts.end(); ++iter) {
+      if (iter->first == merged->first) {
+        merged->second += iter->second;
+      } else {
+        *++merged = *iter;
+      }
+    }
+    counts.erase(merged + 1, counts.end());
+  }
+
+ public:
+  void add(ControlBlock *control_block) {
+    if (!control_block) {
+      return;
+    }
+    if (!counts.empty() && counts.back().first == control_block) {
+      ++counts.back().second;
+    } else {
+      counts.emplace_back(control_block, 1);
+    }
+  }
+
+  void increment_all() {
+    merge();
+    for (const auto& [control_block, count] : counts) {
+      control_block->increment_strong(count);
+    }
+    counts.clear();
+  }
+
+  void decrement_all() {
+    merge();
+    for (const auto& [control_block, count] : counts) {
+      control_block->decrement_strong(count);
+    }
+    counts.clear();
+  }
+};
+
+} // namespace detail
+
+template <typename ForwardIter, typename OutputIter>
+OutputIter copy_n_shared(ForwardIter first, std::size_t count, OutputIter out) {
+  // Count the references first, and then hand out handles that adopt them.
+  // The source handles keep their objects alive in the meantime.
+  detail::RefCountBatch batch;
+  ForwardIter source = first;
+  for (std::size_t i = 0; i < count; ++i, ++source) {
+    batch.add(HandleAccess::control_block(*source));
+  }
+  batch.increment_all();
+
+  std::size_t i = 0;
+  try {
+    while (i < count) {
+      const auto& source_handle = *first;
+      auto handle = HandleAccess::adopt(source_handle.get(),
+                                        HandleAccess::control_block(source_handle));
+      // `handle` now owns its reference, and releases it if the assignment
+      // below throws, so it counts as handed out.
+      ++i;
+      ++first;
+      *out++ = std::move(handle);
+    }
+  } catch (...) {
+    // Give back the references that were not handed out.
+    for (; i < count; ++i, ++first) {
+      if (ControlBlock *control_block = HandleAccess::control_block(*first)) {
+        control_block->decrement_strong();
+      }
+    }
+    throw;
+  }
+  return out;
+}
+
+template <typename ForwardIter>
+void destroy_n_shared(ForwardIter first, std::size_t count) {
+  detail::RefCountBatch batch;
+  for (std::size_t i = 0; i < count; ++i, ++first) {
+    batch.add(HandleAccess::release(*first));
+  }
+  batch.decrement_all();
+}
+
+template <typename Object>
+SharedVector<Object>::SharedVector(std::size_t count,
+                                   const Shared<Object>& handle) {
+  append(count, handle);
+}
+
+template <typename Object>
+SharedVector<Object>::SharedVector(const SharedVector& other) {
+  handles.reserve(other.handles.size());
+  copy_n_shared(other.handles.begin(), other.handles.size(),
+                std::back_inserter(handles));
+}
+
+template <typename Object>
+SharedVector<Object>::~SharedVector() {
+  clear();
+}
+
+template <typename Object>
+SharedVector<Object>& SharedVector<Object>::operator=(const SharedVector& other) {
+  if (this != &other) {
+    SharedVector copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+template <typename Object>
+SharedVector<Object>& SharedVector<Object>::operator=(SharedVector&& other) {
+  if (this != &other) {
+    clear();
+    handles = std::move(other.handles);
+    other.handles.clear();
+  }
+  return *this;
+}
+
+template <typename Object>
+std::size_t SharedVector<Object>::size() const {
+  return handles.size();
+}
+
+template <typename Object>
+bool SharedVector<Object>::empty() const {
+  return handles.empty();
+}
+
+template <typename Object>
+const Shared<Object>& SharedVector<Object>::operator[](std::size_t index) const {
+  return handles[index];
+}
+
+template <typename Object>
+typename SharedVector<Object>::const_iterator SharedVector<Object>::begin() const {
+  return handles.begin();
+}
+
+template <typename Object>
+typename SharedVector<Object>::const_iterator SharedVector<Object>::end() const {
+  return handles.end();
+}
+
+template <typename Object>
+void SharedVector<Object>::reserve(std::size_t capacity) {
+  handles.reserve(capacity);
+}
+
+template <typename Object>
+void SharedVector<Object>::push_back(const Shared<Object>& handle) {
+  handles.push_back(handle);
+}
+
+template <typename Object>
+void SharedVector<Object>::push_back(Shared<Object>&& handle) {
+  handles.push_back(std::move(handle));
+}
+
+template <typename Object>
+void SharedVector<Object>::append(std::size_t count,
+                                  const Shared<Object>& handle) {
+  handles.reserve(handles.size() + count);
+  ControlBlock *control_block = HandleAccess::control_block(handle);
+  if (control_block && count) {
+    control_block->increment_strong(count);
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    handles.push_back(HandleAccess::adopt(handle.get(), control_block));
+  }
+}
+
+template <typename Object>
+void SharedVector<Object>::clear() {
+  destroy_n_shared(handles.begin(), handles.size());
+  handles.clear();
+}
+
+} // namespace ptr
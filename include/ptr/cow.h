@@ -0,0 +1,106 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <utility>
+
+namespace ptr {
+
+// `Cow` is a value type with copy-on-write semantics. Copying a `Cow` shares
+// the underlying object, reading it is free, and `mutate` copies the object
+// only if it is shared. So a `Cow` can be copied "just in case" without paying
+// for a deep copy unless the copy is actually modified.
+// A `Cow` may be copied and read by any number of threads at once, but, like
+// any value, each `Cow` may be mutated only by one thread at a time.
+// A `Cow` always holds a value. It has no move operations, so "moving" one
+// copies it: the source keeps its value, and the two share it until one of
+// them is mutated.
+template <typename Object>
+class Cow {
+  Shared<Object> object;
+
+  bool exclusive() const;
+
+ public:
+  Cow(const Object& value);
+  Cow(Object&& value);
+  template <typename... Args>
+  explicit Cow(std::in_place_t, Args&&... args);
+  // Declaring these suppresses the implicit move operations, which would
+  // leave the source without an object.
+  Cow(const Cow&) = default;
+  Cow& operator=(const Cow&) = default;
+
+  const Object& operator*() const;
+  const Object *operator->() const;
+  const Object *get() const;
+
+  // Return a reference through which the object may be modified, first
+  // copying the object if any other `Cow` or `ptr::Shared` refers to it. The
+  // reference is invalidated by copying `*this` or by `share`.
+  Object& mutate();
+
+  // Return a `ptr::Shared` to the current object. The object is thereafter
+  // shared, so the next `mutate` copies it.
+  Shared<const Object> share() const;
+};
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Object>
+bool Cow<Object>::exclusive() const {
+  // A weak reference could be locked at any time, so it counts as sharing.
+  // Acquire, so that everything that former owners did with the object
+  // happens before whatever we do with it next.
+  ControlBlock *control_block = HandleAccess::control_block(object);
+  const RefCounts counts = RefCounts::from_word(
+    control_block->ref_counts.load(std::memory_order_acquire));
+  return counts.strong == 1 && counts.weak == 0;
+}
+
+template <typename Object>
+Cow<Object>::Cow(const Object& value)
+: object(ptr::make_shared<Object>(value)) {}
+
+template <typename Object>
+Cow<Object>::Cow(Object&& value)
+: object(ptr::make_shared<Object>(std::move(value))) {}
+
+template <typename Object>
+template <typename... Args>
+Cow<Object>::Cow(std::in_place_t, Args&&... args)
+: object(ptr::make_shared<Object>(std::forward<Args>(args)...)) {}
+
+template <typename Object>
+const Object& Cow<Object>::operator*() const {
+  return *object;
+}
+
+template <typename Object>
+const Object *Cow<Object>::operator->() const {
+  return object.get();
+}
+
+template <typename Object>
+const Object *Cow<Object>::get() const {
+  return object.get();
+}
+
+template <typename Object>
+Object& Cow<Object>::mutate() {
+  if (!exclusive()) {
+    object = ptr::make_shared<Object>(std::as_const(*object));
+  }
+  return *object;
+}
+
+template <typename Object>
+Shared<const Object> Cow<Object>::share() const {
+  return object;
+}
+
+} // namespace ptr
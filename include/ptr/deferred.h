@@ -0,0 +1,268 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `LocalShared` is a strong reference that may be used only on the thread
+// that created it, and whose copies and destruction cost no atomic operations.
+// Each thread has a buffer of pending reference counts. The first
+// `LocalShared` for a control block takes one real strong reference on behalf
+// of the buffer; after that, copies and destructions only adjust a plain
+// counter in the buffer's entry for that control block. When a counter drops
+// to zero, the buffer's real reference is not released right away: entries
+// are flushed in batches, at the end of a `DeferredScope`, when enough of
+// them are pending, or when `ptr::flush_deferred` is called at a quiescent
+// point. So a handle that is copied and dropped thousands of times between
+// flushes costs two atomic operations in total.
+// An object is therefore destroyed at the next flush after its last reference
+// goes away, rather than immediately.
+// Use `share` to hand the object to another thread.
+template <typename Object>
+class LocalShared;
+
+// Release the real references of every entry in this thread's buffer that
+// has no `LocalShared` left. This may destroy objects.
+void flush_deferred();
+
+// Return the number of entries in this thread's buffer.
+std::size_t deferred_entries();
+
+// `DeferredScope` calls `ptr::flush_deferred` when it is destroyed, so that a
+// request handler, for example, can use `LocalShared` freely and release
+// everything on the way out.
+class DeferredScope {
+ public:
+  DeferredScope() = default;
+  DeferredScope(const DeferredScope&) = delete;
+  DeferredScope& operator=(const DeferredScope&) = delete;
+  ~DeferredScope();
+};
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `DeferredBuffer` is a thread's table of pending reference counts. Entries
+// are nodes of an `std::unordered_map`, so their addresses are stable, and a
+// `LocalShared` points directly to its entry.
+class DeferredBuffer {
+ public:
+  struct Entry {
+    // `count` is the number of `LocalShared` that refer to the entry.
+    std::uint32_t count = 0;
+  };
+
+ private:
+  std::unordered_map<ControlBlock*, Entry> entries;
+  // `idle` is the number of entries whose `count` is zero.
+  std::size_t idle = 0;
+
+ public:
+  // Flush automatically once this many entries are idle.
+  static constexpr std::size_t flush_threshold = 1024;
+
+  static DeferredBuffer& current() {
+    thread_local DeferredBuffer buffer;
+    return buffer;
+  }
+
+  // Any `LocalShared` still alive at thread exit is a bug, and its entry's
+  // reference is leaked rather than released out from under it.
+  ~DeferredBuffer() {
+    flush();
+  }
+
+  // Return the entry for `control_block` with its `count` incremented. The
+  // caller must own a strong reference for as long as this takes.
+  Entry *acquire(ControlBlock *control_block) {
+    auto [iter, inserted] = entries.try_emplace(control_block);
+    Entry& entry = iter->second;
+    if (inserted) {
+      // The buffer's own reference, released by `flush`.
+      control_block->increment_strong();
+    } else if (entry.count == 0) {
+      --idle;
+    }
+    ++entry.count;
+    return &entry;
+  }
+
+  void release(Entry *entry) {
+    if (--entry->count == 0 && ++idle >= flush_threshold) {
+      flush();
+    }
+  }
+
+  void flush() {
+    // Releasing a reference might destroy an object whose destructor uses
+    // `LocalShared` on this thread, so detach the idle entries before
+    // releasing anything.
+    std::vector<ControlBlock*> released;
+    released.reserve(idle);
+    for (auto iter = entries.begin(); iter != entries.end();) {
+      if (iter->second.count == 0) {
+        released.push_back(iter->first);
+        iter = entries.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    idle = 0;
+    for (ControlBlock *control_block : released) {
+      control_block->decrement_strong();
+    }
+  }
+
+  std::size_t size() const {
+    return entries.size();
+  }
+};
+
+} // namespace detail
+
+template <typename Object>
+class LocalShared {
+  Object *object;
+  detail::DeferredBuffer::Entry *entry;
+  ControlBlock *control_block;
+
+  template <typename Obj>
+  friend class LocalShared;
+
+ public:
+  LocalShared();
+  // Take a reference to the object of `shared`, which costs one atomic
+  // operation the first time for each object between flushes.
+  template <typename Other>
+  explicit LocalShared(const Shared<Other>& shared);
+  LocalShared(const LocalShared&);
+  template <typename Other>
+  LocalShared(const LocalShared<Other>&);
+  LocalShared(LocalShared&&);
+
+  ~LocalShared();
+
+  LocalShared& operator=(LocalShared);
+
+  void reset();
+
+  Object& operator*() const;
+  Object *operator->() const;
+  Object *get() const;
+
+  // Return a `ptr::Shared` to the object, which may be used on any thread.
+  Shared<Object> share() const;
+};
+
+inline void flush_deferred() {
+  detail::DeferredBuffer::current().flush();
+}
+
+inline std::size_t deferred_entries() {
+  return detail::DeferredBuffer::current().size();
+}
+
+inline DeferredScope::~DeferredScope() {
+  flush_deferred();
+}
+
+template <typename Object>
+LocalShared<Object>::LocalShared()
+: object(nullptr)
+, entry(nullptr)
+, control_block(nullptr) {}
+
+template <typename Object>
+template <typename Other>
+LocalShared<Object>::LocalShared(const Shared<Other>& shared)
+: object(shared.get())
+, entry(nullptr)
+, control_block(HandleAccess::control_block(shared)) {
+  if (control_block) {
+    entry = detail::DeferredBuffer::current().acquire(control_block);
+  }
+}
+
+template <typename Object>
+LocalShared<Object>::LocalShared(const LocalShared& other)
+: object(other.object)
+, entry(other.entry)
+, control_block(other.control_block) {
+  if (entry) {
+    ++entry->count;
+  }
+}
+
+template <typename Object>
+template <typename Other>
+LocalShared<Object>::LocalShared(const LocalShared<Other>& other)
+: object(other.object)
+, entry(other.entry)
+, control_block(other.control_block) {
+  if (entry) {
+    ++entry->count;
+  }
+}
+
+template <typename Object>
+LocalShared<Object>::LocalShared(LocalShared&& other)
+: object(std::exchange(other.object, nullptr))
+, entry(std::exchange(other.entry, nullptr))
+, control_block(std::exchange(other.control_block, nullptr)) {}
+
+template <typename Object>
+LocalShared<Object>::~LocalShared() {
+  if (entry) {
+    detail::DeferredBuffer::current().release(entry);
+  }
+}
+
+template <typename Object>
+LocalShared<Object>& LocalShared<Object>::operator=(LocalShared other) {
+  using std::swap;
+  swap(object, other.object);
+  swap(entry, other.entry);
+  swap(control_block, other.control_block);
+  return *this;
+}
+
+template <typename Object>
+void LocalShared<Object>::reset() {
+  *this = LocalShared();
+}
+
+template <typename Object>
+Object& LocalShared<Object>::operator*() const {
+  return *object;
+}
+
+template <typename Object>
+Object *LocalShared<Object>::operator->() const {
+  return object;
+}
+
+template <typename Object>
+Object *LocalShared<Object>::get() const {
+  return object;
+}
+
+template <typename Object>
+Shared<Object> LocalShared<Object>::share() const {
+  if (!control_block) {
+    return Shared<Object>{};
+  }
+  control_block->increment_strong();
+  return HandleAccess::adopt(object, control_block);
+}
+
+} // namespace ptr
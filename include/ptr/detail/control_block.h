@@ -2,7 +2,10 @@
 
 #include <atomic>
 #include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace ptr {
@@ -11,6 +14,16 @@ struct RefCounts {
   std::uint32_t strong;
   std::uint32_t weak;
 
+  // The top two bits of `strong` are flags, not part of the count.
+  // `dead` is set once the strong ref count has reached zero for good. After
+  // that, `strong` is meaningless except for the flags.
+  // `helped` is set, together with `dead`, by an observer that found the
+  // strong ref count at zero before the releasing thread could set `dead`
+  // itself. The releasing thread then clears `helped`, and carries on as if
+  // it had set `dead`.
+  static constexpr std::uint32_t dead = std::uint32_t(1) << 31;
+  static constexpr std::uint32_t helped = std::uint32_t(1) << 30;
+
   static RefCounts from_word(std::uint64_t word) {
     return std::bit_cast<RefCounts>(word);
   }
@@ -18,8 +31,30 @@ struct RefCounts {
   std::uint64_t as_word() const {
     return std::bit_cast<std::uint64_t>(*this);
   }
+
+  // Return the strong ref count, which is zero if `dead` is set.
+  std::uint32_t strong_count() const {
+    return (strong & dead) ? 0 : strong;
+  }
 };
 
+// These are the amounts by which to add to or subtract from a
+// `RefCounts::as_word()` in order to change just one of the counts, whatever
+// the byte order.
+inline constexpr std::uint64_t one_strong = std::bit_cast<std::uint64_t>(
+  RefCounts{.strong = 1, .weak = 0});
+inline constexpr std::uint64_t one_weak = std::bit_cast<std::uint64_t>(
+  RefCounts{.strong = 0, .weak = 1});
+
+// `ControlBlock` counts references using "sticky" zero: once the strong ref
+// count reaches zero and the `RefCounts::dead` flag is set, it never changes
+// again. That lets `try_increment_strong`, which implements
+// `ptr::Weak::lock`, be a single `fetch_add` whose result says whether it
+// succeeded, instead of a compare-and-swap loop that contends with every other
+// thread touching the counts.
+// An increment that lands between a decrement to zero and the setting of the
+// flag succeeds; the releasing thread then finds the count nonzero, and
+// leaves the object alone.
 struct ControlBlock {
   // `ref_counts` is a `RefCounts::as_word()`.
   std::atomic<std::uint64_t> ref_counts;
@@ -29,30 +64,168 @@ struct ControlBlock {
 
   virtual ~ControlBlock() {}
 
-  // Note that `decrement_strong` might `delete this`.
-  virtual void decrement_strong() = 0;
+  // Control blocks are allocated and freed with their size and alignment, so
+  // that the allocator can take its sized fast path, and so that blocks for
+  // over-aligned objects are freed the way they were allocated. The virtual
+  // destructor supplies the size of the most derived block to
+  // `operator delete`.
+  static void *operator new(std::size_t size) {
+    return ::operator new(size);
+  }
+
+  static void *operator new(std::size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+  }
 
-  // Note that `decrement_weak` might `delete this`.
+  static void operator delete(void *block, std::size_t size) {
+    ::operator delete(block, size);
+  }
+
+  static void operator delete(void *block, std::size_t size,
+                              std::align_val_t align) {
+    ::operator delete(block, size, align);
+  }
+
+  // Placement, for control blocks whose memory comes from elsewhere, such as
+  // `ptr::Pool` and `ptr::Arena`.
+  static void *operator new(std::size_t, void *place) noexcept {
+    return place;
+  }
+
+  static void operator delete(void *, void *) noexcept {}
+
+  // The caller must already own a strong reference.
+  void increment_strong(std::uint32_t count = 1) {
+    ref_counts.fetch_add(count * one_strong, std::memory_order_relaxed);
+  }
+
+  // Increment the strong ref count if the object is alive, and return whether
+  // it was.
+  bool try_increment_strong() {
+    // Dead is forever, so don't bother writing if we can see that it's dead.
+    if (RefCounts::from_word(ref_counts.load(std::memory_order_relaxed))
+          .strong & RefCounts::dead) {
+      return false;
+    }
+    const std::uint64_t before =
+      ref_counts.fetch_add(one_strong, std::memory_order_acquire);
+    if (!(RefCounts::from_word(before).strong & RefCounts::dead)) {
+      return true;
+    }
+    // Too late. Undo the increment, so that failed attempts can't accumulate
+    // into the flags. The caller owns a weak reference, so the control block
+    // is still there.
+    ref_counts.fetch_sub(one_strong, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Release `count` strong references at once.
+  // Note that `decrement_strong` might `release_storage`.
+  void decrement_strong(std::uint32_t count = 1) {
+    if (release_strong(count)) {
+      expire();
+    }
+  }
+
+  // `expire` is called exactly once, by whichever thread's `decrement_strong`
+  // brought the strong ref count to zero. At that point the strong references
+  // collectively still hold one weak reference (see `release_strong`), so the
+  // control block is alive for the duration of the call.
+  // Overrides are hooks for observing the death of the managed object, and
+  // must end by doing what this implementation does.
+  virtual void expire() {
+    destroy_object();
+    decrement_weak();
+  }
+
+  virtual void destroy_object() = 0;
+
+  // `release_storage` is called once both ref counts are zero and the object
+  // is destroyed, and frees the control block. Control blocks that do not
+  // come from the global `operator new`, such as those of `ptr::Pool`,
+  // override it.
+  virtual void release_storage() {
+    delete this;
+  }
+
+  // Note that `decrement_weak` might `release_storage`.
   void decrement_weak() {
-    std::uint64_t expected = ref_counts.load();
-    RefCounts desired;
-    do {
-      desired = RefCounts::from_word(expected);
-      --desired.weak;
-    } while (!ref_counts.compare_exchange_weak(expected, desired.as_word()));
-
-    if (desired.weak == 0 && desired.strong == 0) {
-      delete this;
+    const RefCounts before = RefCounts::from_word(
+      ref_counts.fetch_sub(one_weak, std::memory_order_acq_rel));
+    // If `helped` is set, then some thread is on its way to claiming the
+    // expiry of the object, which will add a weak reference.
+    if (before.weak == 1 && (before.strong & RefCounts::dead) &&
+        !(before.strong & RefCounts::helped)) {
+      release_storage();
     }
   }
 
   void increment_weak() {
-    std::uint64_t expected = ref_counts.load();
-    RefCounts desired;
-    do {
-      desired = RefCounts::from_word(expected);
+    ref_counts.fetch_add(one_weak, std::memory_order_relaxed);
+  }
+
+  // Return the current strong ref count. The result is stale as soon as it
+  // is returned unless the caller otherwise excludes other owners. Use
+  // `std::memory_order_acquire` when a result of one (or zero) is going to be
+  // relied upon to access the object exclusively (or not at all).
+  // This is a single load unless the count is caught at zero before the
+  // object is declared dead, in which case we declare it dead on the releasing
+  // thread's behalf, so that a result of zero is final.
+  std::uint32_t strong_count(
+      std::memory_order order = std::memory_order_relaxed) {
+    std::uint64_t expected = ref_counts.load(order);
+    RefCounts counts = RefCounts::from_word(expected);
+    while (counts.strong == 0) {
+      RefCounts desired = counts;
+      desired.strong = RefCounts::dead | RefCounts::helped;
+      if (ref_counts.compare_exchange_weak(expected, desired.as_word(),
+            std::memory_order_acq_rel, order)) {
+        return 0;
+      }
+      counts = RefCounts::from_word(expected);
+    }
+    return counts.strong_count();
+  }
+
+ protected:
+  // Subtract `count` from the strong ref count, and return whether the object
+  // is now dead, in which case the caller is responsible for expiring it.
+  // We must avoid a shared pointer and a weak pointer trying to destroy the
+  // object and free the control block, respectively, at the same time.
+  // The object's storage (or the deleter) is part of the control block.
+  // To avoid destroying an object whose storage is being freed, increment
+  // the weak ref count temporarily when the object is declared dead. The
+  // caller then owes a `decrement_weak`.
+  bool release_strong(std::uint32_t count = 1) {
+    const std::uint64_t before =
+      ref_counts.fetch_sub(count * one_strong, std::memory_order_acq_rel);
+    if (RefCounts::from_word(before).strong != count) {
+      return false;
+    }
+
+    // The count is zero, for now. Try to make it stay that way.
+    std::uint64_t expected = before - count * one_strong;
+    for (;;) {
+      RefCounts counts = RefCounts::from_word(expected);
+      RefCounts desired = counts;
+      if (counts.strong == 0) {
+        desired.strong = RefCounts::dead;
+      } else if (counts.strong & RefCounts::helped) {
+        // An observer declared the object dead for us. Whoever clears
+        // `helped` claims the expiry. Failed `try_increment_strong` might
+        // have left transient increments below the flags; keep them.
+        desired.strong &= ~RefCounts::helped;
+      } else {
+        // Either `try_increment_strong` revived the object, or another
+        // releasing thread (after such a revival) claimed the expiry.
+        return false;
+      }
       ++desired.weak;
-    } while (!ref_counts.compare_exchange_weak(expected, desired.as_word()));
+      if (ref_counts.compare_exchange_weak(expected, desired.as_word(),
+            std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return true;
+      }
+    }
   }
 };
 
@@ -63,35 +236,11 @@ struct InPlaceControlBlock : public ControlBlock {
   explicit InPlaceControlBlock(RefCounts counts)
   : ControlBlock(counts) {}
 
-  // Note that `decrement_strong` might `delete this`.
-  void decrement_strong() override {
-    // We must avoid a shared pointer and a weak pointer trying to destroy the
-    // object and free the control block, respectively, at the same time.
-    // The object's storage is part of the control block.
-    // To avoid destroying an object whose storage is being freed, increment
-    // the weak ref count temporarily when decrementing the strong ref count,
-    // but only if the strong ref count is going to zero.
-    std::uint64_t expected = ref_counts.load();
-    RefCounts desired;
-    do {
-      desired = RefCounts::from_word(expected);
-      --desired.strong;
-      if (desired.strong == 0) {
-        ++desired.weak;
-      }
-    } while (!ref_counts.compare_exchange_weak(expected, desired.as_word()));
-
-    if (desired.strong == 0) {
-      destroy_object();
-      decrement_weak();
-    }
-  }
-
   Object *object() {
     return std::launder(reinterpret_cast<Object*>(storage));
   }
 
-  void destroy_object() {
+  void destroy_object() override {
     object()->~Object();
   }
 };
@@ -112,26 +261,55 @@ struct DeletingControlBlock : public ControlBlock, public Deleter {
   , Deleter(std::forward<DeleterParam>(deleter))
   , object(object) {}
 
-  // Note that `decrement_strong` might `delete this`.
-  void decrement_strong() override {
-    std::uint64_t expected = ref_counts.load();
-    RefCounts desired;
-    do {
-      desired = RefCounts::from_word(expected);
-      --desired.strong;
-    } while (!ref_counts.compare_exchange_weak(expected, desired.as_word()));
-
-    if (desired.strong == 0) {
-      destroy_object();
-      if (desired.weak == 0) {
-        delete this;
-      }
-    }
-  }
-
-  void destroy_object() {
+  void destroy_object() override {
     (*this)(object);
   }
 };
 
+// `SoleOwner` is what a `ptr::Shared` constructed from a raw pointer has in
+// place of a control block until the pointer is first shared: how to destroy
+// the object, and how to make a control block for it when it is shared.
+// A `ptr::Shared` that is created and destroyed without ever being copied
+// thus never allocates.
+struct SoleOwner {
+  void (*destroy)(void *object);
+  ControlBlock *(*materialize)(void *object);
+};
+
+namespace detail {
+
+template <typename Target, typename Deleter>
+inline constexpr SoleOwner sole_owner = {
+  +[](void *object) {
+    Deleter()(static_cast<Target*>(object));
+  },
+  +[](void *object) -> ControlBlock* {
+    return new DeletingControlBlock<Target, Deleter>{
+      RefCounts{.strong = 1, .weak = 0}, Deleter(), static_cast<Target*>(object)};
+  }};
+
+// Only deleters that can be conjured from nothing can be left out of the
+// handle.
+template <typename Deleter>
+inline constexpr bool stateless_deleter =
+  std::is_empty_v<Deleter> && std::is_default_constructible_v<Deleter>;
+
+// A `ptr::Shared` stores a `SoleOwner` in its control block pointer, tagged
+// in the low bit, which is never set in a real control block pointer.
+inline ControlBlock *tag_sole_owner(const SoleOwner *owner) {
+  return reinterpret_cast<ControlBlock*>(
+    reinterpret_cast<std::uintptr_t>(owner) | 1);
+}
+
+inline bool is_sole_owner(const ControlBlock *control_block) {
+  return reinterpret_cast<std::uintptr_t>(control_block) & 1;
+}
+
+inline const SoleOwner *untag_sole_owner(const ControlBlock *control_block) {
+  return reinterpret_cast<const SoleOwner*>(
+    reinterpret_cast<std::uintptr_t>(control_block) & ~std::uintptr_t(1));
+}
+
+} // namespace detail
+
 } // namespace ptr
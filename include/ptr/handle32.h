@@ -0,0 +1,366 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ptr {
+
+// `Handle32` is a strong reference that is four bytes instead of sixteen. Its
+// objects live in slots of an arena that is shared by all objects of the same
+// type, and a handle is the index of its slot together with a few bits of the
+// slot's generation. Graphs whose edges are handles thus take a quarter of the
+// memory, and more of them fit in cache.
+//
+// Each slot is its own control block: a strong count, and a generation that
+// changes every time the slot's object is destroyed. There is no weak count.
+// Instead, a `WeakHandle32` remembers the generation of its object, and
+// `lock` fails if the slot has moved on. So slots are reused as soon as their
+// objects are destroyed, but since a handle keeps only 8 bits of the
+// generation, a weak handle must not outlive 256 reuses of its slot.
+//
+// An arena holds at most 2^24 - 1 objects at once, and never returns its
+// memory to the system.
+template <typename Object>
+class Handle32;
+
+template <typename Object>
+class WeakHandle32;
+
+// Return a handle to a new `Object` constructed from `args`. Throw
+// `std::bad_alloc` if there are already as many objects of the type as
+// handles can address.
+template <typename Object, typename... Args>
+Handle32<Object> make_handle32(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `SlotArena` is the arena of `Handle32<Value>`. Its slots are in chunks that
+// are allocated as needed and never freed, so a slot's address never changes.
+template <typename Value>
+class SlotArena {
+ public:
+  static constexpr unsigned generation_bits = 8;
+  static constexpr std::uint32_t generation_mask = (1u << generation_bits) - 1;
+  static constexpr unsigned chunk_bits = 12;
+  static constexpr std::uint32_t chunk_size = 1u << chunk_bits;
+  static constexpr std::uint32_t max_chunks = 1u << (32 - generation_bits - chunk_bits);
+
+  struct Slot {
+    // The low half of `state` is the strong count, and the high half is the
+    // generation.
+    std::atomic<std::uint64_t> state{0};
+    std::atomic<std::uint32_t> next_free{0};
+    alignas(Value) unsigned char storage[sizeof(Value)];
+
+    Value *object() {
+      return std::launder(reinterpret_cast<Value*>(storage));
+    }
+  };
+
+  static constexpr std::uint64_t one_strong = 1;
+  static constexpr std::uint64_t one_generation = std::uint64_t(1) << 32;
+
+  static std::uint32_t strong(std::uint64_t state) {
+    return std::uint32_t(state);
+  }
+
+  static std::uint32_t generation(std::uint64_t state) {
+    return std::uint32_t(state >> 32) & generation_mask;
+  }
+
+ private:
+  std::atomic<Slot*> chunks[max_chunks] = {};
+  // `free_list` is a stack of free slot indices, linked by `next_free`. The
+  // low half is the top index, and the high half is a tag that changes on
+  // every pop, so that a pop cannot be fooled by the same index having been
+  // popped and pushed in the meantime.
+  std::atomic<std::uint64_t> free_list{0};
+  std::mutex grow_mutex;
+  // `next_chunk` is guarded by `grow_mutex`.
+  std::uint32_t next_chunk = 0;
+
+  // Allocate another chunk and push its slots onto the free list. Index zero
+  // is never used, so that a handle of zero is null.
+  void grow() {
+    std::lock_guard<std::mutex> lock(grow_mutex);
+    if (static_cast<std::uint32_t>(free_list.load(std::memory_order_acquire))) {
+      return;  // Another thread grew the arena while we waited.
+    }
+    if (next_chunk == max_chunks) {
+      throw std::bad_alloc();
+    }
+    const std::uint32_t chunk = next_chunk++;
+    chunks[chunk].store(new Slot[chunk_size], std::memory_order_release);
+    for (std::uint32_t i = chunk_size; i != 0; --i) {
+      const std::uint32_t index = (chunk << chunk_bits) | (i - 1);
+      if (index != 0) {
+        push_free(index);
+      }
+    }
+  }
+
+ public:
+  static SlotArena& instance() {
+    // Never destroyed, so that handles in static objects stay valid.
+    static SlotArena *arena = new SlotArena;
+    return *arena;
+  }
+
+  Slot& slot(std::uint32_t index) const {
+    return chunks[index >> chunk_bits].load(std::memory_order_acquire)[index & (chunk_size - 1)];
+  }
+
+  std::uint32_t pop_free() {
+    for (;;) {
+      std::uint64_t head = free_list.load(std::memory_order_acquire);
+      while (const std::uint32_t index = std::uint32_t(head)) {
+        const std::uint32_t next = slot(index).next_free.load(std::memory_order_relaxed);
+        const std::uint64_t tag = (head >> 32) + 1;
+        if (free_list.compare_exchange_weak(head, (tag << 32) | next,
+                                            std::memory_order_acquire)) {
+          return index;
+        }
+      }
+      grow();
+    }
+  }
+
+  void push_free(std::uint32_t index) {
+    std::uint64_t head = free_list.load(std::memory_order_relaxed);
+    do {
+      slot(index).next_free.store(std::uint32_t(head), std::memory_order_relaxed);
+    } while (!free_list.compare_exchange_weak(
+      head, (head & ~std::uint64_t(0xFFFFFFFF)) | index, std::memory_order_release,
+      std::memory_order_relaxed));
+  }
+
+  // Release a strong reference to the slot at `index`, destroying its object
+  // and freeing the slot if that was the last one.
+  void release(std::uint32_t index) {
+    Slot& target = slot(index);
+    if (strong(target.state.fetch_sub(one_strong, std::memory_order_acq_rel)) != 1) {
+      return;
+    }
+    target.object()->~Value();
+    // Weak handles of the old generation can no longer lock the slot.
+    target.state.fetch_add(one_generation, std::memory_order_release);
+    push_free(index);
+  }
+};
+
+} // namespace detail
+
+template <typename Object>
+class Handle32 {
+  using Value = std::remove_const_t<Object>;
+  using Arena = detail::SlotArena<Value>;
+
+  // The slot index followed by the low bits of the slot's generation, or
+  // zero if null.
+  std::uint32_t value;
+
+  explicit Handle32(std::uint32_t value);
+
+  template <typename Obj>
+  friend class Handle32;
+  template <typename Obj>
+  friend class WeakHandle32;
+  template <typename Obj, typename... Args>
+  friend Handle32<Obj> make_handle32(Args&&...);
+
+ public:
+  Handle32();
+  Handle32(const Handle32&);
+  Handle32(Handle32&&);
+  // Convert a handle to a non-`const` object into one to a `const` object.
+  template <typename Other,
+            typename = std::enable_if_t<std::is_same_v<std::remove_const_t<Other>, Value>>>
+  Handle32(const Handle32<Other>&);
+  ~Handle32();
+
+  Handle32& operator=(Handle32);
+
+  void reset();
+
+  Object& operator*() const;
+  Object *operator->() const;
+  Object *get() const;
+  explicit operator bool() const;
+
+  long use_count() const;
+};
+
+// `WeakHandle32` is a four byte weak reference to the object of a
+// `Handle32`.
+template <typename Object>
+class WeakHandle32 {
+  using Value = std::remove_const_t<Object>;
+  using Arena = detail::SlotArena<Value>;
+
+  std::uint32_t value;
+
+ public:
+  WeakHandle32();
+  WeakHandle32(const Handle32<Object>&);
+
+  void reset();
+
+  // Return a handle to the object if it still exists, or a null handle.
+  Handle32<Object> lock() const;
+  bool expired() const;
+};
+
+template <typename Object>
+Handle32<Object>::Handle32(std::uint32_t value)
+: value(value) {}
+
+template <typename Object>
+Handle32<Object>::Handle32()
+: value(0) {}
+
+template <typename Object>
+Handle32<Object>::Handle32(const Handle32& other)
+: value(other.value) {
+  if (value) {
+    Arena::instance().slot(value >> Arena::generation_bits).state.fetch_add(
+      Arena::one_strong, std::memory_order_relaxed);
+  }
+}
+
+template <typename Object>
+Handle32<Object>::Handle32(Handle32&& other)
+: value(std::exchange(other.value, 0)) {}
+
+template <typename Object>
+template <typename Other, typename>
+Handle32<Object>::Handle32(const Handle32<Other>& other)
+: value(other.value) {
+  if (value) {
+    Arena::instance().slot(value >> Arena::generation_bits).state.fetch_add(
+      Arena::one_strong, std::memory_order_relaxed);
+  }
+}
+
+template <typename Object>
+Handle32<Object>::~Handle32() {
+  if (value) {
+    Arena::instance().release(value >> Arena::generation_bits);
+  }
+}
+
+template <typename Object>
+Handle32<Object>& Handle32<Object>::operator=(Handle32 other) {
+  std::swap(value, other.value);
+  return *this;
+}
+
+template <typename Object>
+void Handle32<Object>::reset() {
+  *this = Handle32();
+}
+
+template <typename Object>
+Object& Handle32<Object>::operator*() const {
+  return *get();
+}
+
+template <typename Object>
+Object *Handle32<Object>::operator->() const {
+  return get();
+}
+
+template <typename Object>
+Object *Handle32<Object>::get() const {
+  if (!value) {
+    return nullptr;
+  }
+  return Arena::instance().slot(value >> Arena::generation_bits).object();
+}
+
+template <typename Object>
+Handle32<Object>::operator bool() const {
+  return value != 0;
+}
+
+template <typename Object>
+long Handle32<Object>::use_count() const {
+  if (!value) {
+    return 0;
+  }
+  return Arena::strong(Arena::instance().slot(value >> Arena::generation_bits).state.load(
+    std::memory_order_relaxed));
+}
+
+template <typename Object>
+WeakHandle32<Object>::WeakHandle32()
+: value(0) {}
+
+template <typename Object>
+WeakHandle32<Object>::WeakHandle32(const Handle32<Object>& handle)
+: value(handle.value) {}
+
+template <typename Object>
+void WeakHandle32<Object>::reset() {
+  value = 0;
+}
+
+template <typename Object>
+Handle32<Object> WeakHandle32<Object>::lock() const {
+  if (!value) {
+    return Handle32<Object>();
+  }
+  auto& slot = Arena::instance().slot(value >> Arena::generation_bits);
+  const std::uint32_t generation = value & Arena::generation_mask;
+  std::uint64_t state = slot.state.load(std::memory_order_relaxed);
+  do {
+    if (Arena::generation(state) != generation || Arena::strong(state) == 0) {
+      return Handle32<Object>();
+    }
+  } while (!slot.state.compare_exchange_weak(state, state + Arena::one_strong,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed));
+  return Handle32<Object>(value);
+}
+
+template <typename Object>
+bool WeakHandle32<Object>::expired() const {
+  if (!value) {
+    return true;
+  }
+  const std::uint64_t state =
+    Arena::instance().slot(value >> Arena::generation_bits).state.load(
+      std::memory_order_acquire);
+  return Arena::generation(state) != (value & Arena::generation_mask) ||
+         Arena::strong(state) == 0;
+}
+
+template <typename Object, typename... Args>
+Handle32<Object> make_handle32(Args&&... args) {
+  using Value = std::remove_const_t<Object>;
+  using Arena = detail::SlotArena<Value>;
+  Arena& arena = Arena::instance();
+  const std::uint32_t index = arena.pop_free();
+  auto& slot = arena.slot(index);
+  try {
+    new (slot.storage) Value(std::forward<Args>(args)...);
+  } catch (...) {
+    arena.push_free(index);
+    throw;
+  }
+  // The slot is free, so its strong count is zero and nothing else writes it.
+  const std::uint64_t state = slot.state.load(std::memory_order_relaxed);
+  slot.state.store(state + Arena::one_strong, std::memory_order_release);
+  return Handle32<Object>((index << Arena::generation_bits) | Arena::generation(state));
+}
+
+} // namespace ptr
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `InternerStats` describes how much an `Interner` has deduplicated so far.
+struct InternerStats {
+  // `hits` is the number of calls to `Interner::intern` that returned an
+  // existing instance, and `misses` the number that created one.
+  std::size_t hits;
+  std::size_t misses;
+  // `live` is the number of canonical instances currently alive.
+  std::size_t live;
+  // `bytes_saved` is the size of the control blocks, values included, that
+  // `hits` separate `ptr::make_shared` calls would have allocated. Memory
+  // that the values themselves own, such as a string's buffer, is not
+  // counted.
+  std::size_t bytes_saved;
+
+  // Return the number of calls to `intern` per instance created, which is at
+  // least one.
+  double dedup_ratio() const {
+    return misses ? double(hits + misses) / misses : 1.0;
+  }
+};
+
+// `Interner` hash-conses immutable values: `intern(value)` returns a
+// `ptr::Shared<const Value>` to the one canonical instance that is equal to
+// `value`, creating it if there isn't one. The interner refers to its
+// instances weakly, so an instance is destroyed when the last handle to it
+// is, and its control block then removes it from the interner.
+// The interner is split into shards, each with a reader-writer lock. Finding
+// an existing instance takes a shard's lock shared, so lookups of common
+// values proceed in parallel. Instances may outlive the `Interner`.
+template <typename Value, typename Hash = std::hash<Value>,
+          typename Equal = std::equal_to<Value>>
+class Interner {
+  struct Shard;
+  struct InternedControlBlock;
+
+  std::vector<Shared<Shard>> shards;
+  Hash hash;
+
+  template <typename Arg>
+  Shared<const Value> intern_value(const Value& key, Arg&& value);
+
+ public:
+  explicit Interner(std::size_t shard_count = 16, Hash hash = Hash(),
+                    Equal equal = Equal());
+
+  // Return the canonical instance equal to `value`, copying or moving
+  // `value` into a new instance if there is none.
+  Shared<const Value> intern(const Value& value);
+  Shared<const Value> intern(Value&& value);
+
+  // Return the number of canonical instances currently alive.
+  std::size_t size() const;
+
+  InternerStats stats() const;
+};
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Value, typename Hash, typename Equal>
+struct Interner<Value, Hash, Equal>::Shard {
+  // The map is keyed by the instance inside each control block.
+  struct KeyHash {
+    Hash hash;
+    std::size_t operator()(const Value *value) const {
+      return hash(*value);
+    }
+  };
+
+  struct KeyEqual {
+    Equal equal;
+    bool operator()(const Value *left, const Value *right) const {
+      return equal(*left, *right);
+    }
+  };
+
+  mutable std::shared_mutex mutex;
+  std::unordered_map<const Value*, InternedControlBlock*, KeyHash, KeyEqual> entries;
+  std::atomic<std::size_t> hits{0};
+  std::atomic<std::size_t> misses{0};
+
+  Shard(const Hash& hash, const Equal& equal)
+  : entries(0, KeyHash{hash}, KeyEqual{equal}) {}
+
+  // Return a strong reference to the live instance equal to `*key`, or null.
+  // The caller must hold `mutex`, shared or not.
+  InternedControlBlock *find(const Value *key) const {
+    auto found = entries.find(key);
+    if (found == entries.end() || !found->second->try_increment_strong()) {
+      return nullptr;
+    }
+    return found->second;
+  }
+
+  // Remove the entry for the instance in `control_block`, unless it has
+  // already been replaced by a newer, equal instance.
+  void purge(InternedControlBlock *control_block) {
+    std::lock_guard<std::shared_mutex> lock(mutex);
+    auto found = entries.find(control_block->object());
+    if (found != entries.end() && found->second == control_block) {
+      entries.erase(found);
+    }
+  }
+};
+
+// `InternedControlBlock` is an `InPlaceControlBlock` that removes its
+// instance from the interner when the instance expires. As in
+// `ptr::WeakCache`, it holds a strong reference to its shard until then.
+template <typename Value, typename Hash, typename Equal>
+struct Interner<Value, Hash, Equal>::InternedControlBlock
+: public InPlaceControlBlock<Value> {
+  Shared<Shard> shard;
+
+  explicit InternedControlBlock(const Shared<Shard>& shard)
+  : InPlaceControlBlock<Value>(RefCounts{.strong = 1, .weak = 0})
+  , shard(shard) {}
+
+  void expire() override {
+    shard->purge(this);
+    shard.reset();
+    InPlaceControlBlock<Value>::expire();
+  }
+};
+
+template <typename Value, typename Hash, typename Equal>
+Interner<Value, Hash, Equal>::Interner(std::size_t shard_count, Hash hash,
+                                       Equal equal)
+: hash(hash) {
+  if (shard_count == 0) {
+    shard_count = 1;
+  }
+  shards.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    shards.push_back(ptr::make_shared<Shard>(hash, equal));
+  }
+}
+
+template <typename Value, typename Hash, typename Equal>
+template <typename Arg>
+Shared<const Value> Interner<Value, Hash, Equal>::intern_value(
+    const Value& key, Arg&& value) {
+  const Shared<Shard>& shard = shards[hash(key) % shards.size()];
+  {
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
+    if (InternedControlBlock *existing = shard->find(&key)) {
+      shard->hits.fetch_add(1, std::memory_order_relaxed);
+      return HandleAccess::adopt<const Value>(existing->object(), existing);
+    }
+  }
+
+  // Build the instance outside of the lock. Another thread might intern an
+  // equal value in the meantime, in which case ours is discarded. From here
+  // on, `key` might have been moved from, so look up the instance instead.
+  auto control_block = std::make_unique<InternedControlBlock>(shard);
+  new (control_block->storage) Value(std::forward<Arg>(value));
+  InternedControlBlock *existing;
+  {
+    std::lock_guard<std::shared_mutex> lock(shard->mutex);
+    existing = shard->find(control_block->object());
+    if (!existing) {
+      // An equal instance that is dead but not yet purged is replaced. Its
+      // entry goes too, since the entry's key points into the dead block.
+      shard->entries.erase(control_block->object());
+      try {
+        shard->entries.emplace(control_block->object(), control_block.get());
+      } catch (...) {
+        control_block->destroy_object();
+        throw;
+      }
+    }
+  }
+
+  if (existing) {
+    // Nobody else has seen our block, so skip its counts.
+    control_block->destroy_object();
+    shard->hits.fetch_add(1, std::memory_order_relaxed);
+    return HandleAccess::adopt<const Value>(existing->object(), existing);
+  }
+  shard->misses.fetch_add(1, std::memory_order_relaxed);
+  InternedControlBlock *created = control_block.release();
+  return HandleAccess::adopt<const Value>(created->object(), created);
+}
+
+template <typename Value, typename Hash, typename Equal>
+Shared<const Value> Interner<Value, Hash, Equal>::intern(const Value& value) {
+  return intern_value(value, value);
+}
+
+template <typename Value, typename Hash, typename Equal>
+Shared<const Value> Interner<Value, Hash, Equal>::intern(Value&& value) {
+  return intern_value(value, std::move(value));
+}
+
+template <typename Value, typename Hash, typename Equal>
+std::size_t Interner<Value, Hash, Equal>::size() const {
+  std::size_t total = 0;
+  for (const Shared<Shard>& shard : shards) {
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
+    total += shard->entries.size();
+  }
+  return total;
+}
+
+template <typename Value, typename Hash, typename Equal>
+InternerStats Interner<Value, Hash, Equal>::stats() const {
+  InternerStats result{};
+  for (const Shared<Shard>& shard : shards) {
+    result.hits += shard->hits.load(std::memory_order_relaxed);
+    result.misses += shard->misses.load(std::memory_order_relaxed);
+  }
+  result.live = size();
+  result.bytes_saved = result.hits * sizeof(InPlaceControlBlock<Value>);
+  return result;
+}
+
+} // namespace ptr
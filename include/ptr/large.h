@@ -0,0 +1,99 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ptr {
+
+// `make_shared_large` is `ptr::make_shared` for large objects that are
+// observed by `ptr::Weak`, such as the values of a weak cache. With
+// `ptr::make_shared`, the object's storage is part of the control block, so
+// it stays allocated until the last weak reference is gone, long after the
+// object is destroyed. Here the control block is its own memory mapping,
+// with the object starting on a page boundary after the counts, and once the
+// object is destroyed, its pages are returned to the operating system while
+// the counts stay. There is still one allocation per object, but it is a
+// system call, so this is for objects of many pages.
+template <typename Object, typename... Args>
+Shared<Object> make_shared_large(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+// The alignment of the object in a `LargeControlBlock`. On systems with
+// larger pages, only the whole pages within the object are released.
+inline constexpr std::size_t large_object_alignment = 4096;
+
+namespace detail {
+
+inline void *map_pages(std::size_t size) {
+  void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  return pages;
+}
+
+// Give the whole pages within `[begin, begin + size)` back to the operating
+// system. They read as zeros afterward.
+inline void discard_pages(void *begin, std::size_t size) {
+#if defined(__linux__)
+  const std::uintptr_t page = sysconf(_SC_PAGESIZE);
+  const std::uintptr_t first = (reinterpret_cast<std::uintptr_t>(begin) + page - 1) / page * page;
+  const std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(begin) + size) / page * page;
+  if (first < last) {
+    madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+  }
+#else
+  (void)begin;
+  (void)size;
+#endif
+}
+
+} // namespace detail
+
+template <typename Object>
+struct alignas(large_object_alignment) LargeControlBlock : public ControlBlock {
+  alignas(large_object_alignment) alignas(Object) char storage[sizeof(Object)];
+
+  explicit LargeControlBlock(RefCounts counts)
+  : ControlBlock(counts) {}
+
+  Object *object() {
+    return std::launder(reinterpret_cast<Object*>(storage));
+  }
+
+  void destroy_object() override {
+    object()->~Object();
+    detail::discard_pages(storage, sizeof(Object));
+  }
+
+  static void *operator new(std::size_t size, std::align_val_t) {
+    return detail::map_pages(size);
+  }
+
+  static void operator delete(void *block, std::size_t size, std::align_val_t) {
+    munmap(block, size);
+  }
+};
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared_large(Args&&... args) {
+  auto control_block = std::make_unique<LargeControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0});
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return HandleAccess::adopt(object, control_block.release());
+}
+
+} // namespace ptr
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `LazyShared` is a shared object, such as a service or a configuration, that
+// is created on first use and may later be replaced. Once the object exists,
+// `get` is a single acquire load that returns a borrowed reference, with no
+// lock and no read-modify-write of a ref count. The first callers to find no
+// object contend for a mutex: one of them calls the factory, and the others
+// wait for its result, so the factory runs once however many threads race.
+//
+// `reload` and `reset` replace the object for subsequent callers, for
+// example when a configuration file changes. A reference that `get` returned
+// earlier may still be in use on another thread, so the replaced object is
+// retired rather than released: it stays alive until `reclaim`, or until the
+// `LazyShared` is destroyed. Callers that need the object to outlive that
+// should take a `ptr::Shared` from `shared` instead.
+//
+// Note that memory grows with every `reload` or `reset` unless something
+// releases the retired objects: either call `reclaim` when it is known to be
+// safe, or give the constructor a `retired_limit`, to keep only that many
+// retired objects, if borrowed references never outlive that many reloads.
+template <typename Object>
+class LazyShared;
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Object>
+class LazyShared {
+  // A `Version` is immutable once published, so readers may copy its handle
+  // without synchronization.
+  struct Version {
+    Shared<Object> object;
+  };
+
+  std::atomic<Version*> current{nullptr};
+  const std::function<Shared<Object>()> factory;
+  const std::size_t retired_limit;
+  std::mutex mutex;
+  // `retired` is guarded by `mutex`, and is oldest first.
+  std::vector<std::unique_ptr<Version>> retired;
+
+  Version *initialize();
+  // Make `object` current, and retire the previous version. The caller holds
+  // `mutex`.
+  void publish(Shared<Object> object);
+  // Add `version`, if any, to `retired`, and release the oldest retired
+  // versions beyond `retired_limit`. The caller holds `mutex`, and has
+  // reserved room in `retired`.
+  void retire(Version *version);
+
+ public:
+  // The default `retired_limit`, which keeps every retired object until
+  // `reclaim`.
+  static constexpr std::size_t keep_all_retired = std::size_t(-1);
+
+  // Create the object, when it is first needed, by calling `factory`, which
+  // must return a non-null handle. `factory` must not use this `LazyShared`.
+  // Keep at most `retired_limit` retired objects; the caller must ensure
+  // that no reference returned by `get` is still in use that many reloads
+  // later.
+  explicit LazyShared(std::function<Shared<Object>()> factory,
+                      std::size_t retired_limit = keep_all_retired);
+  LazyShared(const LazyShared&) = delete;
+  LazyShared& operator=(const LazyShared&) = delete;
+  ~LazyShared();
+
+  // Return the current object, creating it if necessary. If the factory
+  // throws, the exception propagates, and the next call tries again.
+  Object& get();
+  Object& operator*();
+  Object *operator->();
+
+  // Return a strong reference to the current object, creating it if
+  // necessary.
+  Shared<Object> shared();
+
+  // Replace the current object with a new one from the factory, or with
+  // `replacement`.
+  void reload();
+  void reload(Shared<Object> replacement);
+
+  // Retire the current object, so that the next use creates a new one.
+  void reset();
+
+  // Release the retired objects. The caller must ensure that no reference
+  // returned by `get` before the corresponding `reload` or `reset` is still
+  // in use, and that no call to `get` or `shared` that began before then is
+  // still running.
+  void reclaim();
+};
+
+template <typename Object>
+LazyShared<Object>::LazyShared(std::function<Shared<Object>()> factory,
+                               std::size_t retired_limit)
+: factory(std::move(factory))
+, retired_limit(retired_limit) {}
+
+template <typename Object>
+LazyShared<Object>::~LazyShared() {
+  delete current.load(std::memory_order_acquire);
+}
+
+template <typename Object>
+typename LazyShared<Object>::Version *LazyShared<Object>::initialize() {
+  std::lock_guard<std::mutex> lock(mutex);
+  // Another thread might have created the object while we waited.
+  if (Version *version = current.load(std::memory_order_acquire)) {
+    return version;
+  }
+  publish(factory());
+  return current.load(std::memory_order_relaxed);
+}
+
+template <typename Object>
+void LazyShared<Object>::publish(Shared<Object> object) {
+  auto version = std::make_unique<Version>(Version{std::move(object)});
+  retired.reserve(retired.size() + 1);
+  retire(current.exchange(version.release(), std::memory_order_acq_rel));
+}
+
+template <typename Object>
+void LazyShared<Object>::retire(Version *version) {
+  if (!version) {
+    return;
+  }
+  retired.emplace_back(version);
+  if (retired.size() > retired_limit) {
+    retired.erase(retired.begin(), retired.end() - retired_limit);
+  }
+}
+
+template <typename Object>
+Object& LazyShared<Object>::get() {
+  Version *version = current.load(std::memory_order_acquire);
+  if (!version) {
+    version = initialize();
+  }
+  return *version->object;
+}
+
+template <typename Object>
+Object& LazyShared<Object>::operator*() {
+  return get();
+}
+
+template <typename Object>
+Object *LazyShared<Object>::operator->() {
+  return &get();
+}
+
+template <typename Object>
+Shared<Object> LazyShared<Object>::shared() {
+  Version *version = current.load(std::memory_order_acquire);
+  if (!version) {
+    version = initialize();
+  }
+  return version->object;
+}
+
+template <typename Object>
+void LazyShared<Object>::reload() {
+  std::lock_guard<std::mutex> lock(mutex);
+  publish(factory());
+}
+
+template <typename Object>
+void LazyShared<Object>::reload(Shared<Object> replacement) {
+  std::lock_guard<std::mutex> lock(mutex);
+  publish(std::move(replacement));
+}
+
+template <typename Object>
+void LazyShared<Object>::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  retired.reserve(retired.size() + 1);
+  retire(current.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+template <typename Object>
+void LazyShared<Object>::reclaim() {
+  std::vector<std::unique_ptr<Version>> doomed;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    doomed.swap(retired);
+  }
+}
+
+} // namespace ptr
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ptr {
+
+// An `ExpiryHook` is notified when the object that it is registered with dies.
+// Hooks form an intrusive singly linked list, so registering a hook needs no
+// allocation beyond the hook itself.
+struct ExpiryHook {
+  ExpiryHook *next = nullptr;
+
+  virtual ~ExpiryHook() {}
+
+  // `fire` is called at most once, and takes ownership of `this`: it must
+  // eventually `delete this`, directly or by passing the hook along.
+  // `fire` must not throw.
+  virtual void fire() = 0;
+};
+
+// `ExpiryHooks` is the part of a control block that holds its registered
+// `ExpiryHook`s. `ptr::on_expire` and `ptr::ExpiryQueue::watch` find it by
+// casting from `ControlBlock`, whatever the type of the managed object.
+struct ExpiryHooks {
+  // `hooks` is a lock-free stack, most recently registered first.
+  std::atomic<ExpiryHook*> hooks{nullptr};
+
+  ~ExpiryHooks() {
+    // Hooks left over here belong to an object that never expired, which
+    // only happens if its construction failed.
+    ExpiryHook *hook = hooks.load();
+    while (hook) {
+      delete std::exchange(hook, hook->next);
+    }
+  }
+
+  // Register `hook` to fire when the object expires. The caller must hold a
+  // strong reference, so that registration cannot race with expiry.
+  void add_hook(ExpiryHook *hook) {
+    hook->next = hooks.load(std::memory_order_relaxed);
+    while (!hooks.compare_exchange_weak(hook->next, hook,
+        std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+
+  void fire_hooks() {
+    // Reverse the stack to get registration order.
+    ExpiryHook *hook = hooks.exchange(nullptr, std::memory_order_acquire);
+    ExpiryHook *ordered = nullptr;
+    while (hook) {
+      ExpiryHook *next = hook->next;
+      hook->next = ordered;
+      ordered = hook;
+      hook = next;
+    }
+    // Read `next` before firing, because a fired hook belongs to someone else.
+    while (ordered) {
+      std::exchange(ordered, ordered->next)->fire();
+    }
+  }
+};
+
+// `NotifyingControlBlock` is an `InPlaceControlBlock` that fires its
+// registered `ExpiryHook`s exactly once, when the strong ref count reaches
+// zero. Hooks fire before the object is destroyed, in the order in which they
+// were registered. By then the object is unreachable through `ptr::Weak::lock`.
+template <typename Object>
+struct NotifyingControlBlock : public InPlaceControlBlock<Object>,
+                               public ExpiryHooks {
+  explicit NotifyingControlBlock(RefCounts counts)
+  : InPlaceControlBlock<Object>(counts) {}
+
+  void expire() override {
+    fire_hooks();
+    InPlaceControlBlock<Object>::expire();
+  }
+};
+
+// `ExpiryQueue` collects the keys of expired objects, so that a registry can
+// clean up its entries incrementally, on its own schedule, instead of calling
+// `ptr::Weak::lock` on every entry. Any number of threads may expire watched
+// objects concurrently; pushing onto the queue is lock-free and allocation
+// free. Only one thread at a time may `drain` the queue.
+// Watched objects may outlive the queue.
+template <typename Key>
+class ExpiryQueue {
+  struct Node;
+  struct State;
+
+  Shared<State> state;
+
+ public:
+  ExpiryQueue();
+
+  // Arrange for `key` to be delivered by `drain` once `object` expires.
+  // Return `false` without doing anything if `object` was not created by
+  // `ptr::make_shared_notifying`.
+  template <typename Object>
+  bool watch(const Shared<Object>& object, Key key);
+
+  // Call `visit(key)` for the key of each watched object that expired since
+  // the previous `drain`, in no particular order. Return the number of keys
+  // visited.
+  template <typename Visitor>
+  std::size_t drain(Visitor&& visit);
+
+  // Return whether there are no keys waiting to be drained. The result is
+  // immediately stale if watched objects are expiring concurrently.
+  bool empty() const;
+};
+
+// Return a `ptr::Shared` to a new `Object` constructed from `args`, whose
+// control block supports `ptr::on_expire` and `ptr::ExpiryQueue::watch`.
+template <typename Object, typename... Args>
+Shared<Object> make_shared_notifying(Args&&... args);
+
+// Arrange for `callback()` to be called exactly once, on whichever thread
+// releases the last strong reference to `object`'s managed object.
+// Return `false` without doing anything if `object` was not created by
+// `ptr::make_shared_notifying`. `callback` must not throw.
+template <typename Object, typename Callback>
+bool on_expire(const Shared<Object>& object, Callback&& callback);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// Return the `ExpiryHooks` of the control block behind `object`, or return
+// null if `object` is empty or was not created by `ptr::make_shared_notifying`.
+template <typename Object>
+ExpiryHooks *expiry_hooks(const Shared<Object>& object) {
+  // A sole owner has no hooks, and there is no point in allocating a block
+  // to find that out.
+  return dynamic_cast<ExpiryHooks*>(HandleAccess::existing_control_block(object));
+}
+
+template <typename Callback>
+struct CallbackHook : public ExpiryHook {
+  Callback callback;
+
+  template <typename CallbackParam>
+  explicit CallbackHook(CallbackParam&& callback)
+  : callback(std::forward<CallbackParam>(callback)) {}
+
+  void fire() override {
+    callback();
+    delete this;
+  }
+};
+
+} // namespace detail
+
+template <typename Key>
+struct ExpiryQueue<Key>::Node : public ExpiryHook {
+  // `state` is released once the node has been handed to the queue, so that
+  // nodes pending in the queue do not keep the queue alive.
+  Shared<State> state;
+  Key key;
+
+  Node(const Shared<State>& state, Key&& key)
+  : state(state)
+  , key(std::move(key)) {}
+
+  void fire() override {
+    Shared<State> owner = std::move(state);
+    owner->push(this);
+  }
+};
+
+template <typename Key>
+struct ExpiryQueue<Key>::State {
+  // `expired` is a lock-free stack of fired nodes, linked through
+  // `ExpiryHook::next`.
+  std::atomic<ExpiryHook*> expired{nullptr};
+
+  ~State() {
+    ExpiryHook *node = expired.load();
+    while (node) {
+      delete std::exchange(node, node->next);
+    }
+  }
+
+  void push(Node *node) {
+    node->next = expired.load(std::memory_order_relaxed);
+    while (!expired.compare_exchange_weak(node->next, node,
+        std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+};
+
+template <typename Key>
+ExpiryQueue<Key>::ExpiryQueue()
+: state(make_shared<State>()) {}
+
+template <typename Key>
+template <typename Object>
+bool ExpiryQueue<Key>::watch(const Shared<Object>& object, Key key) {
+  ExpiryHooks *hooks = detail::expiry_hooks(object);
+  if (!hooks) {
+    return false;
+  }
+  hooks->add_hook(new Node(state, std::move(key)));
+  return true;
+}
+
+template <typename Key>
+template <typename Visitor>
+std::size_t ExpiryQueue<Key>::drain(Visitor&& visit) {
+  // Taking the whole stack at once means that pops cannot suffer from ABA.
+  ExpiryHook *node = state->expired.exchange(nullptr, std::memory_order_acquire);
+  std::size_t count = 0;
+  while (node) {
+    std::unique_ptr<Node> current{static_cast<Node*>(node)};
+    node = node->next;
+    try {
+      visit(current->key);
+    } catch (...) {
+      // Put back what we have not visited, so that it is not lost.
+      while (node) {
+        state->push(static_cast<Node*>(std::exchange(node, node->next)));
+      }
+      throw;
+    }
+    ++count;
+  }
+  return count;
+}
+
+template <typename Key>
+bool ExpiryQueue<Key>::empty() const {
+  return state->expired.load(std::memory_order_relaxed) == nullptr;
+}
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared_notifying(Args&&... args) {
+  auto control_block = std::make_unique<NotifyingControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0});
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return HandleAccess::adopt(object, control_block.release());
+}
+
+template <typename Object, typename Callback>
+bool on_expire(const Shared<Object>& object, Callback&& callback) {
+  ExpiryHooks *hooks = detail::expiry_hooks(object);
+  if (!hooks) {
+    return false;
+  }
+  hooks->add_hook(new detail::CallbackHook<std::decay_t<Callback>>(
+    std::forward<Callback>(callback)));
+  return true;
+}
+
+} // namespace ptr
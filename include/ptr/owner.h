@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <cstddef>
+
+namespace ptr {
+
+// These function objects order, hash, and compare `ptr::Shared` and
+// `ptr::Weak` handles by the control block that they share ownership of,
+// rather than by the object that they point to. They let handles serve as keys
+// in associative containers, and they accept any mix of `ptr::Shared` and
+// `ptr::Weak` of any object types. A key stays valid after its object expires.
+
+struct OwnerLess {
+  using is_transparent = void;
+
+  template <typename Left, typename Right>
+  bool operator()(const Left& left, const Right& right) const {
+    return left.owner_before(right);
+  }
+};
+
+struct OwnerHash {
+  using is_transparent = void;
+
+  template <typename Handle>
+  std::size_t operator()(const Handle& handle) const {
+    return handle.owner_hash();
+  }
+};
+
+struct OwnerEqual {
+  using is_transparent = void;
+
+  template <typename Left, typename Right>
+  bool operator()(const Left& left, const Right& right) const {
+    return left.owner_equal(right);
+  }
+};
+
+} // namespace ptr
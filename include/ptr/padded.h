@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ptr {
+
+// The size of a cache line on the targets that we care about. This is not
+// `std::hardware_destructive_interference_size`, whose value compilers warn
+// may differ between translation units.
+inline constexpr std::size_t cache_line_size = 64;
+
+// `make_shared_padded` is `ptr::make_shared` for objects that are written
+// often by one thread while other threads copy and release handles to them.
+// `ptr::make_shared` puts the ref counts and the start of the object in one
+// allocation, usually on the same cache line, so each write to the object
+// invalidates the line for threads touching the counts, and vice versa: false
+// sharing. Here the counts get a cache line of their own, and the object
+// starts on the next one, at the cost of up to two cache lines of padding.
+// Objects that are read-mostly are better off with `ptr::make_shared`, where
+// dereferencing a freshly copied handle finds the object already in cache.
+template <typename Object, typename... Args>
+Shared<Object> make_shared_padded(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Object>
+struct alignas(cache_line_size) PaddedControlBlock : public ControlBlock {
+  alignas(cache_line_size) alignas(Object) char storage[sizeof(Object)];
+
+  explicit PaddedControlBlock(RefCounts counts)
+  : ControlBlock(counts) {}
+
+  Object *object() {
+    return std::launder(reinterpret_cast<Object*>(storage));
+  }
+
+  void destroy_object() override {
+    object()->~Object();
+  }
+};
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared_padded(Args&&... args) {
+  auto control_block = std::make_unique<PaddedControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0});
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return HandleAccess::adopt(object, control_block.release());
+}
+
+} // namespace ptr
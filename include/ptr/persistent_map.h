@@ -0,0 +1,424 @@
+#pragma once
+
+#include <ptr/shared.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `PersistentMap` is an immutable hash map whose modifications produce new
+// versions that share most of their structure with the original. It is a hash
+// array mapped trie (HAMT) of `ptr::Shared` nodes, each of which consumes five
+// bits of a key's hash, so that `set` and `erase` copy O(log32 n) nodes, and
+// copying a whole `PersistentMap` is O(1).
+// Versions may be read from any number of threads at once.
+// For batches of modifications, use a `PersistentMap::Transient`, which
+// modifies nodes in place whenever it is their only owner.
+// The map keeps the `Hash` and `Equal` that it was constructed with, and
+// versions derived from it share them.
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class PersistentMap {
+  static constexpr unsigned bits = 5;
+  static constexpr unsigned hash_bits = 8 * sizeof(std::size_t);
+
+  struct Node;
+
+  std::size_t count = 0;
+  // `root` is null if the map is empty.
+  Shared<Node> root;
+  [[no_unique_address]] Hash hasher;
+  [[no_unique_address]] Equal key_equal;
+
+  static Node& editable(Shared<Node>& slot, bool in_place);
+  static Shared<Node> make_pair_node(unsigned shift, std::pair<Key, Value>&& first,
+                                     std::size_t first_hash,
+                                     std::pair<Key, Value>&& second,
+                                     std::size_t second_hash);
+  const Value *find_in(const Node*, unsigned shift, std::size_t hash,
+                       const Key& key) const;
+
+  // These modify `*this`. If `in_place` is true, then nodes that `*this` owns
+  // exclusively are modified in place; otherwise every node along the way is
+  // copied, as it might belong to other versions.
+  void set_in(bool in_place, const Key& key, Value&& value);
+  void erase_in(bool in_place, const Key& key);
+
+  bool insert(Shared<Node>& slot, unsigned shift, std::size_t hash,
+              const Key& key, Value&& value, bool in_place) const;
+  void remove(Shared<Node>& slot, unsigned shift, std::size_t hash,
+              const Key& key, bool in_place) const;
+
+  template <typename Visitor>
+  static void visit(const Node&, Visitor& visitor);
+
+ public:
+  class Transient;
+
+  PersistentMap() = default;
+  explicit PersistentMap(Hash hash, Equal equal = Equal());
+
+  std::size_t size() const;
+  bool empty() const;
+
+  // Return a pointer to the value associated with `key`, or return null if
+  // there is none. The pointer is valid for as long as this version is.
+  const Value *find(const Key& key) const;
+  bool contains(const Key& key) const;
+
+  // Return a new version that associates `key` with `value`.
+  PersistentMap set(const Key& key, Value value) const;
+  // Return a new version without `key`. Return a copy of this version if
+  // there is no `key`.
+  PersistentMap erase(const Key& key) const;
+
+  // Call `visitor(key, value)` for each element, in no particular order.
+  template <typename Visitor>
+  void for_each(Visitor&& visitor) const;
+
+  // Return a `Transient` that begins as a copy of this version.
+  Transient transient() const;
+};
+
+// A `Transient` is a mutable, single-threaded draft of a `PersistentMap`.
+// The first modification of a node that it shares with other versions copies
+// the node, and later modifications of the copy happen in place. Whether the
+// `Transient` owns a node exclusively is decided by the node's strong ref
+// count, so versions made with `persistent()` are never affected by later
+// modifications of the `Transient`.
+template <typename Key, typename Value, typename Hash, typename Equal>
+class PersistentMap<Key, Value, Hash, Equal>::Transient {
+  PersistentMap draft;
+
+  friend class PersistentMap;
+  explicit Transient(const PersistentMap&);
+
+ public:
+  std::size_t size() const;
+  const Value *find(const Key& key) const;
+
+  Transient& set(const Key& key, Value value);
+  Transient& erase(const Key& key);
+
+  // Return the current state of the draft as a `PersistentMap`. The
+  // `Transient` remains usable.
+  PersistentMap persistent() const;
+};
+
+// --------------
+// Implementation
+// --------------
+
+// Each `Node` stores entries and children in separate arrays, each ordered
+// by the five-bit fragment of the hash that selects them, and compressed by a
+// bitmap that says which fragments are present (the "CHAMP" layout).
+// Once all of the bits of the hash are consumed, a node is a collision node:
+// its bitmaps are unused, and `entries` is searched linearly.
+template <typename Key, typename Value, typename Hash, typename Equal>
+struct PersistentMap<Key, Value, Hash, Equal>::Node {
+  std::uint32_t entry_map = 0;
+  std::uint32_t child_map = 0;
+  std::vector<std::pair<Key, Value>> entries;
+  std::vector<Shared<Node>> children;
+
+  static std::uint32_t bit(unsigned shift, std::size_t hash) {
+    return std::uint32_t(1) << ((hash >> shift) & ((1u << bits) - 1));
+  }
+
+  static std::size_t index(std::uint32_t map, std::uint32_t bit) {
+    return std::popcount(map & (bit - 1));
+  }
+};
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+PersistentMap<Key, Value, Hash, Equal>::PersistentMap(Hash hash, Equal equal)
+: hasher(std::move(hash))
+, key_equal(std::move(equal)) {}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+typename PersistentMap<Key, Value, Hash, Equal>::Node&
+PersistentMap<Key, Value, Hash, Equal>::editable(Shared<Node>& slot,
+                                                 bool in_place) {
+  if (!slot.get()) {
+    slot = make_shared<Node>();
+  } else if (!in_place || !slot.unique()) {
+    slot = make_shared<Node>(*slot);
+  }
+  return *slot;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+Shared<typename PersistentMap<Key, Value, Hash, Equal>::Node>
+PersistentMap<Key, Value, Hash, Equal>::make_pair_node(
+    unsigned shift, std::pair<Key, Value>&& first, std::size_t first_hash,
+    std::pair<Key, Value>&& second, std::size_t second_hash) {
+  auto node = make_shared<Node>();
+  if (shift >= hash_bits) {
+    node->entries.push_back(std::move(first));
+    node->entries.push_back(std::move(second));
+    return node;
+  }
+
+  const std::uint32_t first_bit = Node::bit(shift, first_hash);
+  const std::uint32_t second_bit = Node::bit(shift, second_hash);
+  if (first_bit == second_bit) {
+    node->child_map = first_bit;
+    node->children.push_back(make_pair_node(
+      shift + bits, std::move(first), first_hash, std::move(second), second_hash));
+    return node;
+  }
+
+  node->entry_map = first_bit | second_bit;
+  if (second_bit < first_bit) {
+    std::swap(first, second);
+  }
+  node->entries.push_back(std::move(first));
+  node->entries.push_back(std::move(second));
+  return node;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+const Value *PersistentMap<Key, Value, Hash, Equal>::find_in(
+    const Node *node, unsigned shift, std::size_t hash, const Key& key) const {
+  for (; node; shift += bits) {
+    if (shift >= hash_bits) {
+      for (const auto& entry : node->entries) {
+        if (key_equal(entry.first, key)) {
+          return &entry.second;
+        }
+      }
+      return nullptr;
+    }
+
+    const std::uint32_t bit = Node::bit(shift, hash);
+    if (node->entry_map & bit) {
+      const auto& entry = node->entries[Node::index(node->entry_map, bit)];
+      return key_equal(entry.first, key) ? &entry.second : nullptr;
+    }
+    if (!(node->child_map & bit)) {
+      return nullptr;
+    }
+    node = node->children[Node::index(node->child_map, bit)].get();
+  }
+  return nullptr;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+bool PersistentMap<Key, Value, Hash, Equal>::insert(
+    Shared<Node>& slot, unsigned shift, std::size_t hash, const Key& key,
+    Value&& value, bool in_place) const {
+  Node& node = editable(slot, in_place);
+  if (shift >= hash_bits) {
+    for (auto& entry : node.entries) {
+      if (key_equal(entry.first, key)) {
+        entry.second = std::move(value);
+        return false;
+      }
+    }
+    node.entries.emplace_back(key, std::move(value));
+    return true;
+  }
+
+  const std::uint32_t bit = Node::bit(shift, hash);
+  if (node.entry_map & bit) {
+    const std::size_t index = Node::index(node.entry_map, bit);
+    auto& entry = node.entries[index];
+    if (key_equal(entry.first, key)) {
+      entry.second = std::move(value);
+      return false;
+    }
+    // Two keys share this fragment, so they move down into a new child. The
+    // child gets a copy of the existing entry, and everything that can throw
+    // happens before `node` changes, so that a failure leaves a node being
+    // edited in place as it was.
+    const std::size_t other_hash = hasher(entry.first);
+    node.children.reserve(node.children.size() + 1);
+    Shared<Node> child = make_pair_node(
+      shift + bits, std::pair<Key, Value>(entry), other_hash,
+      std::pair<Key, Value>(key, std::move(value)), hash);
+    node.children.insert(
+      node.children.begin() + Node::index(node.child_map, bit), std::move(child));
+    node.child_map |= bit;
+    node.entries.erase(node.entries.begin() + index);
+    node.entry_map &= ~bit;
+    return true;
+  }
+  if (node.child_map & bit) {
+    return insert(node.children[Node::index(node.child_map, bit)], shift + bits,
+                  hash, key, std::move(value), in_place);
+  }
+  node.entries.emplace(node.entries.begin() + Node::index(node.entry_map, bit),
+                       key, std::move(value));
+  node.entry_map |= bit;
+  return true;
+}
+
+// `remove` requires that `key` be present.
+template <typename Key, typename Value, typename Hash, typename Equal>
+void PersistentMap<Key, Value, Hash, Equal>::remove(
+    Shared<Node>& slot, unsigned shift, std::size_t hash, const Key& key,
+    bool in_place) const {
+  Node& node = editable(slot, in_place);
+  if (shift >= hash_bits) {
+    for (auto iter = node.entries.begin(); iter != node.entries.end(); ++iter) {
+      if (key_equal(iter->first, key)) {
+        node.entries.erase(iter);
+        return;
+      }
+    }
+    return;
+  }
+
+  const std::uint32_t bit = Node::bit(shift, hash);
+  if (node.entry_map & bit) {
+    node.entries.erase(node.entries.begin() + Node::index(node.entry_map, bit));
+    node.entry_map &= ~bit;
+    return;
+  }
+
+  const std::size_t index = Node::index(node.child_map, bit);
+  Shared<Node>& child = node.children[index];
+  remove(child, shift + bits, hash, key, in_place);
+  // Keep the trie canonical: a child left with at most one entry and no
+  // children of its own is folded into this node.
+  if (!child->children.empty() || child->entries.size() > 1) {
+    return;
+  }
+  if (child->entries.size() == 1) {
+    auto entry = std::move(child->entries.front());
+    node.entries.insert(
+      node.entries.begin() + Node::index(node.entry_map, bit), std::move(entry));
+    node.entry_map |= bit;
+  }
+  node.children.erase(node.children.begin() + index);
+  node.child_map &= ~bit;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+template <typename Visitor>
+void PersistentMap<Key, Value, Hash, Equal>::visit(const Node& node,
+                                                   Visitor& visitor) {
+  for (const auto& entry : node.entries) {
+    visitor(entry.first, entry.second);
+  }
+  for (const Shared<Node>& child : node.children) {
+    visit(*child, visitor);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+void PersistentMap<Key, Value, Hash, Equal>::set_in(bool in_place,
+                                                    const Key& key,
+                                                    Value&& value) {
+  if (insert(root, 0, hasher(key), key, std::move(value), in_place)) {
+    ++count;
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+void PersistentMap<Key, Value, Hash, Equal>::erase_in(bool in_place,
+                                                      const Key& key) {
+  const std::size_t hash = hasher(key);
+  // Look before leaping, so that erasing a missing key copies nothing.
+  if (!find_in(root.get(), 0, hash, key)) {
+    return;
+  }
+  remove(root, 0, hash, key, in_place);
+  if (--count == 0) {
+    root.reset();
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+std::size_t PersistentMap<Key, Value, Hash, Equal>::size() const {
+  return count;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+bool PersistentMap<Key, Value, Hash, Equal>::empty() const {
+  return count == 0;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+const Value *PersistentMap<Key, Value, Hash, Equal>::find(const Key& key) const {
+  return find_in(root.get(), 0, hasher(key), key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+bool PersistentMap<Key, Value, Hash, Equal>::contains(const Key& key) const {
+  return find(key) != nullptr;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+PersistentMap<Key, Value, Hash, Equal>
+PersistentMap<Key, Value, Hash, Equal>::set(const Key& key, Value value) const {
+  PersistentMap result = *this;
+  result.set_in(false, key, std::move(value));
+  return result;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+PersistentMap<Key, Value, Hash, Equal>
+PersistentMap<Key, Value, Hash, Equal>::erase(const Key& key) const {
+  PersistentMap result = *this;
+  result.erase_in(false, key);
+  return result;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+template <typename Visitor>
+void PersistentMap<Key, Value, Hash, Equal>::for_each(Visitor&& visitor) const {
+  if (root.get()) {
+    visit(*root, visitor);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+typename PersistentMap<Key, Value, Hash, Equal>::Transient
+PersistentMap<Key, Value, Hash, Equal>::transient() const {
+  return Transient(*this);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+PersistentMap<Key, Value, Hash, Equal>::Transient::Transient(
+    const PersistentMap& original)
+: draft(original) {}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+std::size_t PersistentMap<Key, Value, Hash, Equal>::Transient::size() const {
+  return draft.size();
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+const Value *PersistentMap<Key, Value, Hash, Equal>::Transient::find(
+    const Key& key) const {
+  return draft.find(key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+typename PersistentMap<Key, Value, Hash, Equal>::Transient&
+PersistentMap<Key, Value, Hash, Equal>::Transient::set(const Key& key,
+                                                       Value value) {
+  draft.set_in(true, key, std::move(value));
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+typename PersistentMap<Key, Value, Hash, Equal>::Transient&
+PersistentMap<Key, Value, Hash, Equal>::Transient::erase(const Key& key) {
+  draft.erase_in(true, key);
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+PersistentMap<Key, Value, Hash, Equal>
+PersistentMap<Key, Value, Hash, Equal>::Transient::persistent() const {
+  return draft;
+}
+
+} // namespace ptr
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <ptr/shared.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace ptr {
+
+// `PersistentVector` is an immutable sequence whose modifications produce new
+// versions that share most of their structure with the original. It is a
+// 32-way trie of `ptr::Shared` nodes, plus a "tail" node holding up to the
+// last 32 elements, so that `push_back` and `set` copy O(log32 n) nodes, and
+// copying a whole `PersistentVector` is O(1).
+// Versions may be read from any number of threads at once.
+// For batches of modifications, use a `PersistentVector::Transient`, which
+// modifies nodes in place whenever it is their only owner.
+template <typename Value>
+class PersistentVector {
+  static constexpr unsigned bits = 5;
+  static constexpr std::size_t width = std::size_t(1) << bits;
+  static constexpr std::size_t mask = width - 1;
+
+  struct Node {};
+  struct Branch;
+  struct Leaf;
+
+  std::size_t count = 0;
+  // `shift` is `bits` times the number of levels of branches in the trie.
+  unsigned shift = bits;
+  // `root` is a `Branch`, or null if all elements are in `tail`.
+  Shared<Node> root;
+  // `tail` is a `Leaf`, or null if the vector is empty.
+  Shared<Node> tail;
+
+  std::size_t tail_offset() const;
+  const Value *leaf_for(std::size_t index) const;
+
+  // These modify `*this`. If `in_place` is true, then nodes that `*this` owns
+  // exclusively are modified in place; otherwise every node along the way is
+  // copied, as it might belong to other versions.
+  template <typename Node_>
+  static Node_& editable(Shared<Node>& slot, bool in_place);
+  static Shared<Node> new_path(unsigned level, Shared<Node> node);
+  void push_tail(Shared<Node>& slot, unsigned level, Shared<Node> node,
+                 bool in_place);
+  template <typename... Args>
+  void emplace_back_at(bool in_place, Args&&... args);
+  template <typename Arg>
+  void set_at(bool in_place, std::size_t index, Arg&& value);
+
+ public:
+  class Transient;
+  class const_iterator;
+
+  PersistentVector() = default;
+
+  std::size_t size() const;
+  bool empty() const;
+
+  // The behavior is undefined unless `index < size()`.
+  const Value& operator[](std::size_t index) const;
+  // Throw `std::out_of_range` unless `index < size()`.
+  const Value& at(std::size_t index) const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // Return a new version with `value` appended.
+  PersistentVector push_back(Value value) const;
+  // Return a new version with the element at `index` replaced by `value`.
+  // The behavior is undefined unless `index < size()`.
+  PersistentVector set(std::size_t index, Value value) const;
+
+  // Return a `Transient` that begins as a copy of this version.
+  Transient transient() const;
+};
+
+// A `Transient` is a mutable, single-threaded draft of a `PersistentVector`.
+// The first modification of a node that it shares with other versions copies
+// the node, and later modifications of the copy happen in place, which makes
+// a batch of modifications much cheaper than the same modifications made one
+// version at a time. Whether the `Transient` owns a node exclusively is
+// decided by the node's strong ref count, so versions made with
+// `persistent()` are never affected by later modifications of the `Transient`.
+template <typename Value>
+class PersistentVector<Value>::Transient {
+  PersistentVector draft;
+
+  friend class PersistentVector;
+  explicit Transient(const PersistentVector&);
+
+ public:
+  std::size_t size() const;
+  const Value& operator[](std::size_t index) const;
+
+  Transient& push_back(Value value);
+  template <typename... Args>
+  Transient& emplace_back(Args&&... args);
+  Transient& set(std::size_t index, Value value);
+
+  // Return the current state of the draft as a `PersistentVector`. The
+  // `Transient` remains usable.
+  PersistentVector persistent() const;
+};
+
+template <typename Value>
+class PersistentVector<Value>::const_iterator {
+  const PersistentVector *vector = nullptr;
+  std::size_t index = 0;
+  const Value *leaf = nullptr;
+
+  friend class PersistentVector;
+  const_iterator(const PersistentVector *vector, std::size_t index);
+
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Value*;
+  using reference = const Value&;
+
+  const_iterator() = default;
+
+  reference operator*() const;
+  pointer operator->() const;
+  const_iterator& operator++();
+  const_iterator operator++(int);
+
+  bool operator==(const const_iterator&) const;
+};
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Value>
+struct PersistentVector<Value>::Branch : public Node {
+  std::array<Shared<Node>, width> children;
+};
+
+// A `Leaf` holds up to `width` elements inline, so that `Value` need not be
+// default constructible.
+template <typename Value>
+struct PersistentVector<Value>::Leaf : public Node {
+  std::uint32_t size = 0;
+  alignas(Value) unsigned char storage[width * sizeof(Value)];
+
+  Leaf() = default;
+
+  // If copying an element throws, the elements copied so far are destroyed,
+  // since `~Leaf` does not run for a partly constructed `Leaf`.
+  Leaf(const Leaf& other) {
+    std::uninitialized_copy_n(other.data(), other.size,
+                              reinterpret_cast<Value*>(storage));
+    size = other.size;
+  }
+
+  Leaf& operator=(const Leaf&) = delete;
+
+  ~Leaf() {
+    for (std::uint32_t i = 0; i < size; ++i) {
+      data()[i].~Value();
+    }
+  }
+
+  Value *data() {
+    return std::launder(reinterpret_cast<Value*>(storage));
+  }
+
+  const Value *data() const {
+    return std::launder(reinterpret_cast<const Value*>(storage));
+  }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    new (storage + size * sizeof(Value)) Value(std::forward<Args>(args)...);
+    ++size;
+  }
+};
+
+template <typename Value>
+std::size_t PersistentVector<Value>::tail_offset() const {
+  return count < width ? 0 : ((count - 1) >> bits) << bits;
+}
+
+template <typename Value>
+const Value *PersistentVector<Value>::leaf_for(std::size_t index) const {
+  if (index >= tail_offset()) {
+    return static_cast<const Leaf*>(tail.get())->data();
+  }
+  const Node *node = root.get();
+  for (unsigned level = shift; level > 0; level -= bits) {
+    node = static_cast<const Branch*>(node)->children[(index >> level) & mask].get();
+  }
+  return static_cast<const Leaf*>(node)->data();
+}
+
+template <typename Value>
+template <typename Node_>
+Node_& PersistentVector<Value>::editable(Shared<Node>& slot, bool in_place) {
+  if (!slot.get()) {
+    slot = make_shared<Node_>();
+  } else if (!in_place || !slot.unique()) {
+    slot = make_shared<Node_>(static_cast<const Node_&>(*slot));
+  }
+  return static_cast<Node_&>(*slot);
+}
+
+template <typename Value>
+Shared<typename PersistentVector<Value>::Node>
+PersistentVector<Value>::new_path(unsigned level, Shared<Node> node) {
+  if (level == 0) {
+    return node;
+  }
+  auto branch = make_shared<Branch>();
+  branch->children[0] = new_path(level - bits, std::move(node));
+  return branch;
+}
+
+template <typename Value>
+void PersistentVector<Value>::push_tail(Shared<Node>& slot, unsigned level,
+                                        Shared<Node> node, bool in_place) {
+  Branch& branch = editable<Branch>(slot, in_place);
+  Shared<Node>& child = branch.children[((count - 1) >> level) & mask];
+  if (level == bits) {
+    child = std::move(node);
+  } else if (child.get()) {
+    push_tail(child, level - bits, std::move(node), in_place);
+  } else {
+    child = new_path(level - bits, std::move(node));
+  }
+}
+
+template <typename Value>
+template <typename... Args>
+void PersistentVector<Value>::emplace_back_at(bool in_place, Args&&... args) {
+  if (count - tail_offset() < width) {
+    editable<Leaf>(tail, in_place).emplace_back(std::forward<Args>(args)...);
+    ++count;
+    return;
+  }
+
+  // The tail is full, so it moves into the trie. Leave `*this` unchanged
+  // until nothing else can throw.
+  Shared<Node> new_tail = make_shared<Leaf>();
+  static_cast<Leaf&>(*new_tail).emplace_back(std::forward<Args>(args)...);
+  if ((count >> bits) > (std::size_t(1) << shift)) {
+    // The trie is full, so it grows a level.
+    Shared<Node> new_root = make_shared<Branch>();
+    auto& children = static_cast<Branch&>(*new_root).children;
+    children[0] = root;
+    children[1] = new_path(shift, tail);
+    root = std::move(new_root);
+    shift += bits;
+  } else {
+    push_tail(root, shift, tail, in_place);
+  }
+  tail = std::move(new_tail);
+  ++count;
+}
+
+template <typename Value>
+template <typename Arg>
+void PersistentVector<Value>::set_at(bool in_place, std::size_t index,
+                                     Arg&& value) {
+  Shared<Node> *slot = &tail;
+  if (index < tail_offset()) {
+    slot = &root;
+    for (unsigned level = shift; level > 0; level -= bits) {
+      slot = &editable<Branch>(*slot, in_place).children[(index >> level) & mask];
+    }
+  }
+  editable<Leaf>(*slot, in_place).data()[index & mask] = std::forward<Arg>(value);
+}
+
+template <typename Value>
+std::size_t PersistentVector<Value>::size() const {
+  return count;
+}
+
+template <typename Value>
+bool PersistentVector<Value>::empty() const {
+  return count == 0;
+}
+
+template <typename Value>
+const Value& PersistentVector<Value>::operator[](std::size_t index) const {
+  return leaf_for(index)[index & mask];
+}
+
+template <typename Value>
+const Value& PersistentVector<Value>::at(std::size_t index) const {
+  if (index >= count) {
+    throw std::out_of_range("ptr::PersistentVector::at");
+  }
+  return (*this)[index];
+}
+
+template <typename Value>
+typename PersistentVector<Value>::const_iterator
+PersistentVector<Value>::begin() const {
+  return const_iterator(this, 0);
+}
+
+template <typename Value>
+typename PersistentVector<Value>::const_iterator
+PersistentVector<Value>::end() const {
+  return const_iterator(this, count);
+}
+
+template <typename Value>
+PersistentVector<Value> PersistentVector<Value>::push_back(Value value) const {
+  PersistentVector result = *this;
+  result.emplace_back_at(false, std::move(value));
+  return result;
+}
+
+template <typename Value>
+PersistentVector<Value> PersistentVector<Value>::set(std::size_t index,
+                                                     Value value) const {
+  PersistentVector result = *this;
+  result.set_at(false, index, std::move(value));
+  return result;
+}
+
+template <typename Value>
+typename PersistentVector<Value>::Transient
+PersistentVector<Value>::transient() const {
+  return Transient(*this);
+}
+
+template <typename Value>
+PersistentVector<Value>::Transient::Transient(const PersistentVector& original)
+: draft(original) {}
+
+template <typename Value>
+std::size_t PersistentVector<Value>::Transient::size() const {
+  return draft.size();
+}
+
+template <typename Value>
+const Value& PersistentVector<Value>::Transient::operator[](
+    std::size_t index) const {
+  return draft[index];
+}
+
+template <typename Value>
+typename PersistentVector<Value>::Transient&
+PersistentVector<Value>::Transient::push_back(Value value) {
+  draft.emplace_back_at(true, std::move(value));
+  return *this;
+}
+
+template <typename Value>
+template <typename... Args>
+typename PersistentVector<Value>::Transient&
+PersistentVector<Value>::Transient::emplace_back(Args&&... args) {
+  draft.emplace_back_at(true, std::forward<Args>(args)...);
+  return *this;
+}
+
+template <typename Value>
+typename PersistentVector<Value>::Transient&
+PersistentVector<Value>::Transient::set(std::size_t index, Value value) {
+  draft.set_at(true, index, std::move(value));
+  return *this;
+}
+
+template <typename Value>
+PersistentVector<Value> PersistentVector<Value>::Transient::persistent() const {
+  return draft;
+}
+
+template <typename Value>
+PersistentVector<Value>::const_iterator::const_iterator(
+    const PersistentVector *vector, std::size_t index)
+: vector(vector)
+, index(index)
+, leaf(index < vector->count ? vector->leaf_for(index) : nullptr) {}
+
+template <typename Value>
+const Value& PersistentVector<Value>::const_iterator::operator*() const {
+  return leaf[index & mask];
+}
+
+template <typename Value>
+const Value *PersistentVector<Value>::const_iterator::operator->() const {
+  return &leaf[index & mask];
+}
+
+template <typename Value>
+typename PersistentVector<Value>::const_iterator&
+PersistentVector<Value>::const_iterator::operator++() {
+  ++index;
+  if ((index & mask) == 0) {
+    leaf = index < vector->count ? vector->leaf_for(index) : nullptr;
+  }
+  return *this;
+}
+
+template <typename Value>
+typename PersistentVector<Value>::const_iterator
+PersistentVector<Value>::const_iterator::operator++(int) {
+  const_iterator old = *this;
+  ++*this;
+  return old;
+}
+
+template <typename Value>
+bool PersistentVector<Value>::const_iterator::operator==(
+    const const_iterator& other) const {
+  return index == other.index;
+}
+
+} // namespace ptr
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `Pool` is a `ptr::make_shared` for one type that carves its control blocks
+// out of slabs of many blocks at a time, instead of allocating each one from
+// the global heap. A block returns to its pool when both its strong and weak
+// references are gone, and is reused by the next allocation.
+// Objects may outlive their `Pool`: the slabs are freed once the `Pool` and
+// all of its blocks are gone. Objects may be released on any thread.
+// Slabs are not returned to the system while the pool is in use, so a pool's
+// memory is the high-water mark of its live objects.
+template <typename Object>
+class Pool;
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+template <typename Object>
+class PoolState;
+
+template <typename Object>
+struct PooledControlBlock : public InPlaceControlBlock<Object> {
+  PoolState<Object> *pool;
+
+  PooledControlBlock(RefCounts counts, PoolState<Object> *pool)
+  : InPlaceControlBlock<Object>(counts)
+  , pool(pool) {}
+
+  void release_storage() override {
+    PoolState<Object> *owner = pool;
+    this->~PooledControlBlock();
+    owner->deallocate(this);
+  }
+};
+
+// `PoolState` is the part of a `Pool` that lives as long as the pool or any
+// of its blocks.
+template <typename Object>
+class PoolState {
+  using Block = PooledControlBlock<Object>;
+
+  union Slot {
+    Slot *next;
+    alignas(Block) unsigned char storage[sizeof(Block)];
+  };
+
+  // `references` is one for the `Pool` plus one for each allocated block.
+  std::atomic<std::size_t> references{1};
+  const std::size_t slab_size;
+  // Blocks are released on any thread, so they are pushed onto `returned`
+  // without a lock. Allocation takes all of them at once, under `mutex`,
+  // which avoids the ABA problem of popping one at a time.
+  std::atomic<Slot*> returned{nullptr};
+  std::mutex mutex;
+  // `free` and `slabs` are guarded by `mutex`.
+  Slot *free = nullptr;
+  std::vector<std::unique_ptr<Slot[]>> slabs;
+
+  void add_slab() {
+    slabs.emplace_back(new Slot[slab_size]);
+    Slot *slab = slabs.back().get();
+    for (std::size_t i = 0; i < slab_size; ++i) {
+      slab[i].next = i + 1 < slab_size ? &slab[i + 1] : free;
+    }
+    free = slab;
+  }
+
+ public:
+  explicit PoolState(std::size_t slab_size)
+  : slab_size(slab_size ? slab_size : 1) {}
+
+  void *allocate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!free) {
+      free = returned.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!free) {
+      add_slab();
+    }
+    Slot *slot = free;
+    free = slot->next;
+    references.fetch_add(1, std::memory_order_relaxed);
+    return slot->storage;
+  }
+
+  void deallocate(void *storage) {
+    Slot *slot = static_cast<Slot*>(storage);
+    slot->next = returned.load(std::memory_order_relaxed);
+    while (!returned.compare_exchange_weak(slot->next, slot,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+    release();
+  }
+
+  void release() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  std::size_t slab_count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slabs.size();
+  }
+};
+
+} // namespace detail
+
+template <typename Object>
+class Pool {
+  detail::PoolState<Object> *state;
+
+ public:
+  // Allocate blocks `slab_size` at a time.
+  explicit Pool(std::size_t slab_size = 256);
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+  ~Pool();
+
+  // Return a handle to a new `Object` constructed from `args`, whose control
+  // block comes from this pool.
+  template <typename... Args>
+  Shared<Object> make_shared(Args&&... args);
+
+  // Return the number of slabs allocated so far.
+  std::size_t slab_count() const;
+};
+
+template <typename Object>
+Pool<Object>::Pool(std::size_t slab_size)
+: state(new detail::PoolState<Object>(slab_size)) {}
+
+template <typename Object>
+Pool<Object>::~Pool() {
+  state->release();
+}
+
+template <typename Object>
+template <typename... Args>
+Shared<Object> Pool<Object>::make_shared(Args&&... args) {
+  using Block = detail::PooledControlBlock<Object>;
+  auto *control_block =
+    new (state->allocate()) Block(RefCounts{.strong = 1, .weak = 0}, state);
+  Object *object;
+  try {
+    object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  } catch (...) {
+    control_block->release_storage();
+    throw;
+  }
+  return HandleAccess::adopt(object, control_block);
+}
+
+template <typename Object>
+std::size_t Pool<Object>::slab_count() const {
+  return state->slab_count();
+}
+
+} // namespace ptr
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace ptr {
+
+// `Publisher` holds the current version of an object that is read far more
+// often than it changes, such as a configuration. `publish` replaces the
+// object and bumps a version number. Readers go through a `Publisher::Reader`,
+// typically one per thread in a `thread_local`, which caches the last
+// `ptr::Shared` that it fetched together with its version. A read is then a
+// relaxed load of the version that finds it unchanged, and touches neither
+// the publisher's slot nor any ref count, so readers on different threads
+// write to no cache line that they share. Only when the version has changed
+// does a reader lock the slot and copy the new handle.
+// A reader sees a new version shortly after it is published, not at once,
+// and keeps the version that it last read alive until its next read. The
+// `Publisher` must outlive its readers.
+template <typename Object>
+class Publisher;
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Object>
+class Publisher {
+  std::atomic<std::uint64_t> published_version{0};
+  mutable std::mutex mutex;
+  // `current` is guarded by `mutex`.
+  Shared<Object> current;
+
+ public:
+  class Reader;
+
+  explicit Publisher(Shared<Object> initial = Shared<Object>());
+  Publisher(const Publisher&) = delete;
+  Publisher& operator=(const Publisher&) = delete;
+
+  // Make `object` the current version.
+  void publish(Shared<Object> object);
+
+  // Return the current version, without a `Reader`'s cache.
+  Shared<Object> snapshot() const;
+
+  // Return the number of times that `publish` has been called.
+  std::uint64_t version() const;
+};
+
+template <typename Object>
+class Publisher<Object>::Reader {
+  const Publisher *publisher;
+  std::uint64_t cached_version;
+  Shared<Object> cached;
+
+  void refresh();
+
+ public:
+  explicit Reader(const Publisher& publisher);
+
+  // Return the most recently published object that this reader has seen,
+  // first checking for a newer one.
+  const Shared<Object>& get();
+  Object& operator*();
+  Object *operator->();
+};
+
+template <typename Object>
+Publisher<Object>::Publisher(Shared<Object> initial)
+: current(std::move(initial)) {}
+
+template <typename Object>
+void Publisher<Object>::publish(Shared<Object> object) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    swap(current, object);
+    published_version.store(published_version.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+  }
+  // The previous version, now in `object`, is released outside of the lock.
+}
+
+template <typename Object>
+Shared<Object> Publisher<Object>::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current;
+}
+
+template <typename Object>
+std::uint64_t Publisher<Object>::version() const {
+  return published_version.load(std::memory_order_relaxed);
+}
+
+template <typename Object>
+Publisher<Object>::Reader::Reader(const Publisher& publisher)
+: publisher(&publisher) {
+  refresh();
+}
+
+template <typename Object>
+void Publisher<Object>::Reader::refresh() {
+  Shared<Object> previous;
+  {
+    // The version and the handle are read together under the lock, so the
+    // version cached is the one that goes with the handle cached.
+    std::lock_guard<std::mutex> lock(publisher->mutex);
+    cached_version = publisher->published_version.load(std::memory_order_relaxed);
+    previous = std::exchange(cached, publisher->current);
+  }
+}
+
+template <typename Object>
+const Shared<Object>& Publisher<Object>::Reader::get() {
+  // Relaxed is enough: the object is reached through `cached`, which was
+  // copied under the lock, not through anything that the version orders.
+  if (publisher->published_version.load(std::memory_order_relaxed) != cached_version) {
+    refresh();
+  }
+  return cached;
+}
+
+template <typename Object>
+Object& Publisher<Object>::Reader::operator*() {
+  return *get();
+}
+
+template <typename Object>
+Object *Publisher<Object>::Reader::operator->() {
+  return get().get();
+}
+
+} // namespace ptr
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace ptr {
+
+// `NoReset` is the `reset` of a `Recycler` whose objects need no resetting.
+template <typename Object>
+struct NoReset {
+  void operator()(Object&) const {}
+};
+
+// `Recycler` hands out `ptr::Shared` to objects that are expensive to
+// construct, such as buffers that reserve a large capacity, and reuses them
+// instead of destroying them. When an object's strong ref count reaches zero,
+// the recycler calls `reset(object)`, which should return the object to a
+// freshly constructed state without giving up its resources. When the weak
+// references are gone too, the object and its control block go onto a free
+// list, still constructed, for the next acquisition.
+// At most `capacity` objects are kept; the rest are destroyed as usual.
+// Objects may outlive their `Recycler`, and may be released on any thread.
+// `reset` must not throw.
+template <typename Object, typename Reset = NoReset<Object>>
+class Recycler;
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+template <typename Object, typename Reset>
+class RecyclerState;
+
+template <typename Object, typename Reset>
+struct RecyclingControlBlock : public InPlaceControlBlock<Object> {
+  RecyclerState<Object, Reset> *recycler;
+  // `next` links free blocks.
+  RecyclingControlBlock *next = nullptr;
+
+  explicit RecyclingControlBlock(RecyclerState<Object, Reset> *recycler)
+  : InPlaceControlBlock<Object>(RefCounts{.strong = 1, .weak = 0})
+  , recycler(recycler) {}
+
+  // The object is reset rather than destroyed, but to any `ptr::Weak` it is
+  // gone all the same.
+  void destroy_object() override {
+    recycler->reset(*this->object());
+  }
+
+  void release_storage() override {
+    RecyclerState<Object, Reset> *owner = recycler;
+    owner->recycle(this);
+    owner->release();
+  }
+};
+
+// `RecyclerState` is the part of a `Recycler` that lives as long as the
+// recycler or any of its objects that are in use.
+template <typename Object, typename Reset>
+class RecyclerState : private Reset {
+  using Block = RecyclingControlBlock<Object, Reset>;
+
+  // `references` is one for the `Recycler` plus one for each block in use.
+  std::atomic<std::size_t> references{1};
+  const std::size_t capacity;
+  // Once the `Recycler` is gone, released objects are destroyed.
+  std::atomic<bool> closed{false};
+  std::atomic<std::size_t> pooled{0};
+  std::atomic<std::size_t> hit_count{0};
+  std::atomic<std::size_t> miss_count{0};
+  // As in `ptr::Pool`, blocks are pushed onto `returned` without a lock, and
+  // acquisitions take all of them at once, under `mutex`, when `free` is
+  // empty.
+  std::atomic<Block*> returned{nullptr};
+  std::mutex mutex;
+  // `free` is guarded by `mutex`.
+  Block *free = nullptr;
+
+  // Destroy `block` and the blocks linked after it.
+  static void destroy_all(Block *block) {
+    while (block) {
+      Block *next = block->next;
+      block->object()->~Object();
+      delete block;
+      block = next;
+    }
+  }
+
+ public:
+  RecyclerState(std::size_t capacity, Reset&& reset)
+  : Reset(std::move(reset))
+  , capacity(capacity) {}
+
+  RecyclerState(const RecyclerState&) = delete;
+  RecyclerState& operator=(const RecyclerState&) = delete;
+
+  ~RecyclerState() {
+    destroy_all(free);
+    destroy_all(returned.load(std::memory_order_acquire));
+  }
+
+  // Return a free block, with its object reset and its strong ref count at
+  // one, or null if there isn't one.
+  Block *take() {
+    Block *block;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!free) {
+        free = returned.exchange(nullptr, std::memory_order_acquire);
+      }
+      block = free;
+      if (!block) {
+        miss_count.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      }
+      free = std::exchange(block->next, nullptr);
+    }
+    pooled.fetch_sub(1, std::memory_order_relaxed);
+    hit_count.fetch_add(1, std::memory_order_relaxed);
+    references.fetch_add(1, std::memory_order_relaxed);
+    // Nothing else refers to the block, so the counts can simply be stored.
+    block->ref_counts.store(RefCounts{.strong = 1, .weak = 0}.as_word(),
+                            std::memory_order_relaxed);
+    return block;
+  }
+
+  template <typename... Args>
+  Block *make(Args&&... args) {
+    auto block = std::make_unique<Block>(this);
+    new (block->storage) Object(std::forward<Args>(args)...);
+    references.fetch_add(1, std::memory_order_relaxed);
+    return block.release();
+  }
+
+  void reset(Object& object) {
+    static_cast<Reset&>(*this)(object);
+  }
+
+  // Keep `block` for reuse if there is room, or destroy it.
+  void recycle(Block *block) {
+    if (closed.load(std::memory_order_relaxed)) {
+      destroy_all(block);
+      return;
+    }
+    if (pooled.fetch_add(1, std::memory_order_relaxed) >= capacity) {
+      pooled.fetch_sub(1, std::memory_order_relaxed);
+      destroy_all(block);
+      return;
+    }
+    block->next = returned.load(std::memory_order_relaxed);
+    while (!returned.compare_exchange_weak(block->next, block,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+  }
+
+  // Destroy the objects waiting to be reused, and stop keeping any more.
+  // Blocks being recycled concurrently are destroyed with the state.
+  void close() {
+    closed.store(true, std::memory_order_relaxed);
+    Block *blocks;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocks = std::exchange(free, nullptr);
+    }
+    destroy_all(blocks);
+    destroy_all(returned.exchange(nullptr, std::memory_order_acquire));
+  }
+
+  void release() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  std::size_t hits() const {
+    return hit_count.load(std::memory_order_relaxed);
+  }
+
+  std::size_t misses() const {
+    return miss_count.load(std::memory_order_relaxed);
+  }
+
+  std::size_t size() const {
+    return pooled.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace detail
+
+template <typename Object, typename Reset>
+class Recycler {
+  detail::RecyclerState<Object, Reset> *state;
+
+ public:
+  // Keep at most `capacity` unused objects.
+  explicit Recycler(std::size_t capacity, Reset reset = Reset());
+  Recycler(const Recycler&) = delete;
+  Recycler& operator=(const Recycler&) = delete;
+  ~Recycler();
+
+  // Return a handle to a recycled object if there is one, or otherwise to a
+  // new, value-initialized `Object`.
+  Shared<Object> acquire();
+  // Return a handle to a recycled object if there is one, or otherwise to a
+  // new `Object` constructed from `args`. Note that `args` are used only to
+  // construct a new object: a recycled object is returned as `reset` left
+  // it, whatever `args` say.
+  template <typename... Args>
+  Shared<Object> acquire_or_construct(Args&&... args);
+
+  // Return the number of acquisitions that reused an object.
+  std::size_t hits() const;
+  // Return the number of acquisitions that constructed an object.
+  std::size_t misses() const;
+  // Return the number of objects waiting to be reused.
+  std::size_t size() const;
+};
+
+template <typename Object, typename Reset>
+Recycler<Object, Reset>::Recycler(std::size_t capacity, Reset reset)
+: state(new detail::RecyclerState<Object, Reset>(capacity, std::move(reset))) {}
+
+template <typename Object, typename Reset>
+Recycler<Object, Reset>::~Recycler() {
+  state->close();
+  state->release();
+}
+
+template <typename Object, typename Reset>
+Shared<Object> Recycler<Object, Reset>::acquire() {
+  return acquire_or_construct();
+}
+
+template <typename Object, typename Reset>
+template <typename... Args>
+Shared<Object> Recycler<Object, Reset>::acquire_or_construct(Args&&... args) {
+  auto *block = state->take();
+  if (!block) {
+    block = state->make(std::forward<Args>(args)...);
+  }
+  return HandleAccess::adopt(block->object(), block);
+}
+
+template <typename Object, typename Reset>
+std::size_t Recycler<Object, Reset>::hits() const {
+  return state->hits();
+}
+
+template <typename Object, typename Reset>
+std::size_t Recycler<Object, Reset>::misses() const {
+  return state->misses();
+}
+
+template <typename Object, typename Reset>
+std::size_t Recycler<Object, Reset>::size() const {
+  return state->size();
+}
+
+} // namespace ptr
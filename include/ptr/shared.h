@@ -2,15 +2,31 @@
 
 #include <ptr/detail/control_block.h>
 
+#include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
+#include <utility>
 
 namespace ptr {
 
+struct HandleAccess;
+
+template <typename Object>
+class Weak;
+
+template <typename Object>
+class Unique;
+
 template <typename Object>
 class Shared {
   Object *object;
-  ControlBlock *control_block;
+  // `control_block` is a tagged `SoleOwner` (see `<ptr/detail/control_block.h>`)
+  // while this handle is the only one ever to have owned the object. It
+  // stays that way until a copy or a `ptr::Weak` needs a real control block.
+  // `const` operations may thus replace it, atomically; see
+  // `shared_control_block`.
+  mutable ControlBlock *control_block;
 
   template <typename Obj, typename... Args>
   friend Shared<Obj> make_shared(Args&&...);
@@ -24,9 +40,15 @@ class Shared {
   template <typename Obj>
   friend class Weak;
 
+  friend struct HandleAccess;
+
   template <typename Target>
   Shared(Target*, ControlBlock*);
 
+  // Return the control block, first allocating it if this handle is a sole
+  // owner. This is safe to call concurrently on one handle.
+  ControlBlock *shared_control_block() const;
+
   template <typename Other>
   Shared& copy_assign(const Shared<Other>&);
   template <typename Other>
@@ -49,6 +71,10 @@ class Shared {
   Shared(const Shared<Managed>&, Alias*);
   template <typename Managed, typename Alias>
   Shared(Shared<Managed>&&, Alias*);
+  // Take over the object of a `ptr::Unique` (see `<ptr/unique.h>`), which
+  // costs no allocation and no atomic operation.
+  template <typename Other>
+  Shared(Unique<Other>&&);
 
   ~Shared();
 
@@ -67,6 +93,19 @@ class Shared {
   Object *operator->() const;
 
   Object *get() const;
+
+  long use_count() const;
+  bool unique() const;
+
+  template <typename Other>
+  bool owner_before(const Shared<Other>&) const;
+  template <typename Other>
+  bool owner_before(const Weak<Other>&) const;
+  template <typename Other>
+  bool owner_equal(const Shared<Other>&) const;
+  template <typename Other>
+  bool owner_equal(const Weak<Other>&) const;
+  std::size_t owner_hash() const;
 };
 
 template <typename Object, typename... Args>
@@ -75,6 +114,35 @@ Shared<Object> make_shared(Args&&... args);
 template <typename Object>
 void swap(Shared<Object>&, Shared<Object>&);
 
+// `HandleAccess` is how the rest of the library builds handles around control
+// blocks that it allocated itself, and how it inspects the control block
+// behind a `ptr::Shared` or `ptr::Weak`. It is not part of the public
+// interface.
+struct HandleAccess {
+  // Return a `ptr::Shared` that takes over one strong reference, already
+  // counted in `control_block`, to `object`.
+  template <typename Object>
+  static Shared<Object> adopt(Object *object, ControlBlock *control_block);
+
+  template <typename Handle>
+  static ControlBlock *control_block(const Handle&);
+  // A `ptr::Shared` that is a sole owner gets a control block first.
+  template <typename Object>
+  static ControlBlock *control_block(const Shared<Object>&);
+
+  // Return the control block of `handle`, or null if it is empty or is a
+  // sole owner. Unlike `control_block`, this never allocates.
+  template <typename Object>
+  static ControlBlock *existing_control_block(const Shared<Object>&);
+
+  // Empty `handle` without releasing its strong reference, which the caller
+  // takes over, and return its control block. A sole owner has no control
+  // block to hand over, and making one could throw, so its object is
+  // destroyed here instead, and null is returned.
+  template <typename Object>
+  static ControlBlock *release(Shared<Object>& handle);
+};
+
 // --------------
 // Implementation
 // --------------
@@ -104,6 +172,14 @@ template <typename Object>
 template <typename Target, typename Deleter>
 Shared<Object>::Shared(Target *raw, Deleter&& deleter)
 : object(raw) {
+  using Stored = std::decay_t<Deleter>;
+  // A sole owner must be able to delete through `object`.
+  if constexpr (detail::stateless_deleter<Stored> &&
+                std::is_same_v<std::remove_cv_t<Target>, std::remove_cv_t<Object>>) {
+    control_block = detail::tag_sole_owner(
+      &detail::sole_owner<std::remove_cv_t<Target>, Stored>);
+    return;
+  }
   // TODO: Is the control block for an Object or for a Target?
   control_block = new DeletingControlBlock<Target, Deleter>{
     RefCounts{.strong = 1, .weak = 0},
@@ -129,22 +205,22 @@ template <typename Object>
 Shared<Object>::Shared(Shared<Object>&& other)
 : Shared(std::move(other), other.object) {}
 
+template <typename Object>
+template <typename Other>
+Shared<Object>::Shared(Unique<Other>&& other)
+: object(std::exchange(other.object, nullptr))
+, control_block(std::exchange(other.control_block, nullptr)) {}
+
 template <typename Object>
 template <typename Managed, typename Alias>
 Shared<Object>::Shared(const Shared<Managed>& other, Alias *alias)
 : object(alias)
-, control_block(other.control_block) {
+, control_block(other.shared_control_block()) {
   if (!control_block) {
     return;
   }
 
-  // Increment the strong ref count.
-  std::uint64_t expected = control_block->ref_counts.load();
-  RefCounts desired;
-  do {
-    desired = RefCounts::from_word(expected);
-    ++desired.strong;
-  } while (!control_block->ref_counts.compare_exchange_weak(expected, desired.as_word()));
+  control_block->increment_strong();
 }
 
 template <typename Object>
@@ -152,9 +228,14 @@ template <typename Managed, typename Alias>
 Shared<Object>::Shared(Shared<Managed>&& other, Alias* alias)
 : object(alias)
 , control_block(other.control_block) {
-  if (&other == this) {
+  if (static_cast<const void*>(&other) == this) {
     return;
   }
+  // A sole owner must point to the object that it owns.
+  if (detail::is_sole_owner(control_block) &&
+      static_cast<const void*>(object) != static_cast<const void*>(other.object)) {
+    control_block = other.shared_control_block();
+  }
   other.control_block = nullptr;
   other.object = nullptr;
 }
@@ -165,15 +246,45 @@ Shared<Object>::~Shared() {
     return;
   }
 
+  if (detail::is_sole_owner(control_block)) {
+    detail::untag_sole_owner(control_block)->destroy(
+      const_cast<void*>(static_cast<const void*>(object)));
+    return;
+  }
+
   // Decrement the strong ref count, possibly destroy the object, and possibly
   // delete the control block.
   control_block->decrement_strong();
 }
 
+template <typename Object>
+ControlBlock *Shared<Object>::shared_control_block() const {
+  std::atomic_ref<ControlBlock*> slot(control_block);
+  ControlBlock *current = slot.load(std::memory_order_acquire);
+  if (!detail::is_sole_owner(current)) {
+    return current;
+  }
+
+  ControlBlock *materialized = detail::untag_sole_owner(current)->materialize(
+    const_cast<void*>(static_cast<const void*>(object)));
+  if (slot.compare_exchange_strong(current, materialized,
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_acquire)) {
+    return materialized;
+  }
+  // Another thread shared this handle first. Its control block doesn't own
+  // the object until it is installed, so ours can go without destroying it.
+  delete materialized;
+  return current;
+}
+
 template <typename Object>
 template <typename Other>
 Shared<Object>& Shared<Object>::copy_assign(const Shared<Other>& other) {
-  if (other.control_block == control_block) {
+  if (static_cast<const void*>(&other) == this) {
+    return *this;
+  }
+  if (other.shared_control_block() == control_block) {
     object = other.object;
     return *this;
   }
@@ -186,7 +297,7 @@ Shared<Object>& Shared<Object>::copy_assign(const Shared<Other>& other) {
 template <typename Object>
 template <typename Other>
 Shared<Object>& Shared<Object>::move_assign(Shared<Other>&& other) {
-  if (&other == this) {
+  if (static_cast<const void*>(&other) == this) {
     return *this;
   }
 
@@ -245,6 +356,60 @@ Object *Shared<Object>::get() const {
   return object;
 }
 
+template <typename Object>
+long Shared<Object>::use_count() const {
+  ControlBlock *current =
+    std::atomic_ref<ControlBlock*>(control_block).load(std::memory_order_acquire);
+  if (!current) {
+    return 0;
+  }
+  if (detail::is_sole_owner(current)) {
+    return 1;
+  }
+  return current->strong_count();
+}
+
+template <typename Object>
+bool Shared<Object>::unique() const {
+  // Acquire, so that if we are the only owner, everything that former owners
+  // did with the object happens before whatever we do next.
+  ControlBlock *current =
+    std::atomic_ref<ControlBlock*>(control_block).load(std::memory_order_acquire);
+  return current && (detail::is_sole_owner(current) ||
+                     current->strong_count(std::memory_order_acquire) == 1);
+}
+
+template <typename Object>
+template <typename Other>
+bool Shared<Object>::owner_before(const Shared<Other>& other) const {
+  return std::less<ControlBlock*>{}(shared_control_block(),
+                                    HandleAccess::control_block(other));
+}
+
+template <typename Object>
+template <typename Other>
+bool Shared<Object>::owner_before(const Weak<Other>& other) const {
+  return std::less<ControlBlock*>{}(shared_control_block(),
+                                    HandleAccess::control_block(other));
+}
+
+template <typename Object>
+template <typename Other>
+bool Shared<Object>::owner_equal(const Shared<Other>& other) const {
+  return shared_control_block() == HandleAccess::control_block(other);
+}
+
+template <typename Object>
+template <typename Other>
+bool Shared<Object>::owner_equal(const Weak<Other>& other) const {
+  return shared_control_block() == HandleAccess::control_block(other);
+}
+
+template <typename Object>
+std::size_t Shared<Object>::owner_hash() const {
+  return std::hash<ControlBlock*>{}(shared_control_block());
+}
+
 template <typename Object, typename... Args>
 Shared<Object> make_shared(Args&&... args) {
   Shared<Object> result;
@@ -258,6 +423,40 @@ Shared<Object> make_shared(Args&&... args) {
   return result;
 }
 
+template <typename Object>
+Shared<Object> HandleAccess::adopt(Object *object, ControlBlock *control_block) {
+  return Shared<Object>{object, control_block};
+}
+
+template <typename Handle>
+ControlBlock *HandleAccess::control_block(const Handle& handle) {
+  return handle.control_block;
+}
+
+template <typename Object>
+ControlBlock *HandleAccess::control_block(const Shared<Object>& handle) {
+  return handle.shared_control_block();
+}
+
+template <typename Object>
+ControlBlock *HandleAccess::existing_control_block(const Shared<Object>& handle) {
+  ControlBlock *current = std::atomic_ref<ControlBlock*>(handle.control_block)
+    .load(std::memory_order_acquire);
+  return detail::is_sole_owner(current) ? nullptr : current;
+}
+
+template <typename Object>
+ControlBlock *HandleAccess::release(Shared<Object>& handle) {
+  if (detail::is_sole_owner(handle.control_block)) {
+    handle.reset();
+    return nullptr;
+  }
+  ControlBlock *control_block = handle.control_block;
+  handle.object = nullptr;
+  handle.control_block = nullptr;
+  return control_block;
+}
+
 template <typename Object>
 void swap(Shared<Object>& left, Shared<Object>& right) {
   using std::swap;
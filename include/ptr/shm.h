@@ -0,0 +1,552 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ptr::shm {
+
+// This namespace is a variant of `ptr::Shared` whose objects live in a shared
+// memory `Region` that several processes map, possibly at different
+// addresses. Nothing in a region refers to anything by address: blocks and
+// free lists are linked by `Offset` from the start of the region, reference
+// counts are lock-free atomics, and control blocks have no virtual functions,
+// so a handle in any process can release an object that another process
+// created. The objects themselves must likewise not contain pointers.
+//
+// A producer creates an object with `ptr::shm::make_shared`, and passes it to
+// another process by sending the `Offset` returned by `Shared::release` over
+// a socket or pipe. The consumer takes over that reference with
+// `Shared::adopt`. The object's bytes are never copied.
+//
+// There are no weak references. A process that dies while holding references
+// leaks them.
+//
+// The allocator's lock is a spin lock in the region. A process that dies
+// while holding it, which it does only inside `Region::allocate` and
+// `Region::deallocate`, leaves it held for good, and every other process
+// that maps the region then deadlocks the next time it allocates or frees.
+
+// `Offset` is a position in a `Region`, in bytes from its start. Zero means
+// null.
+using Offset = std::uint64_t;
+
+// `Region` is a mapping of a shared memory file, and an allocator of the
+// memory within it. The allocator's state is in the region too, so any
+// process may allocate and deallocate.
+class Region {
+  struct Header;
+
+  int file;
+  char *base;
+  std::size_t length;
+
+  Region(int file, char *base, std::size_t length);
+  Header& header() const;
+
+ public:
+  // Create a new anonymous shared memory file of `size` bytes, and map it.
+  // Throw `std::system_error` if that fails.
+  static Region create(std::size_t size);
+  // Map the region that another `Region` created, given a descriptor for its
+  // file, which the new `Region` takes ownership of. For example, `file`
+  // might be inherited across `fork` or received over a UNIX domain socket.
+  // Throw `std::system_error` if that fails.
+  static Region open(int file);
+
+  Region(const Region&) = delete;
+  Region& operator=(const Region&) = delete;
+  // Unmap the region. Handles into the region must already be gone.
+  ~Region();
+
+  // Return the file descriptor of the region's shared memory file.
+  int fd() const;
+  std::size_t size() const;
+
+  // Return `bytes` bytes of memory aligned to `max_align`, or throw
+  // `std::bad_alloc` if the region is full.
+  void *allocate(std::size_t bytes);
+  // Return memory obtained from `allocate`, in this or any other process.
+  void deallocate(void *memory);
+
+  static constexpr std::size_t max_align = 16;
+
+  Offset offset_of(const void *address) const;
+  void *address_of(Offset offset) const;
+};
+
+// `Shared` is a strong reference to an array of `Object` in a `Region`, or to
+// a single `Object`, which is an array of one. The region must outlive the
+// handle.
+template <typename Object>
+class Shared {
+  using Value = std::remove_const_t<Object>;
+
+  struct Block;
+
+  Region *region;
+  Block *block;
+
+  Shared(Region *region, Block *block);
+
+  template <typename Obj, typename... Args>
+  friend Shared<Obj> make_shared(Region&, Args&&...);
+  template <typename Obj>
+  friend Shared<Obj> make_shared_array(Region&, std::size_t);
+
+ public:
+  Shared();
+  Shared(const Shared&);
+  Shared(Shared&&);
+  ~Shared();
+
+  Shared& operator=(Shared);
+
+  void reset();
+
+  Object& operator*() const;
+  Object *operator->() const;
+  Object& operator[](std::size_t index) const;
+  Object *get() const;
+  // Return the number of elements in the array.
+  std::size_t size() const;
+  explicit operator bool() const;
+
+  long use_count() const;
+
+  // Empty this handle without releasing its reference, and return an offset
+  // through which a handle in any process that maps the same region can take
+  // over the reference, using `adopt`. Return zero if the handle is empty.
+  Offset release();
+  // Return a handle that takes over the reference given up by `release`.
+  static Shared adopt(Region& region, Offset offset);
+};
+
+// Return a handle to a new `Object` in `region`, constructed from `args`.
+// `Object` must be aligned to at most `Region::max_align`.
+template <typename Object, typename... Args>
+Shared<Object> make_shared(Region& region, Args&&... args);
+
+// Return a handle to a new array of `count` value-initialized `Object` in
+// `region`.
+template <typename Object>
+Shared<Object> make_shared_array(Region& region, std::size_t count);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "reference counts must be usable across processes");
+
+// `SpinLock` is a lock that works across processes, because all of its state
+// is one word in shared memory.
+class SpinLock {
+  std::atomic<std::uint32_t>& word;
+
+ public:
+  explicit SpinLock(std::atomic<std::uint32_t>& word)
+  : word(word) {
+    while (word.exchange(1, std::memory_order_acquire)) {
+      while (word.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  SpinLock(const SpinLock&) = delete;
+  SpinLock& operator=(const SpinLock&) = delete;
+
+  ~SpinLock() {
+    word.store(0, std::memory_order_release);
+  }
+};
+
+// Each allocation is preceded by a `Chunk`. `next` links free chunks.
+struct Chunk {
+  std::uint64_t size;
+  Offset next;
+};
+
+static_assert(sizeof(Chunk) == Region::max_align);
+
+inline std::size_t round_up(std::size_t bytes, std::size_t align) {
+  return (bytes + align - 1) / align * align;
+}
+
+[[noreturn]] inline void throw_errno(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline int create_file(std::size_t size) {
+#if defined(__linux__)
+  const int file = memfd_create("ptr-shm", MFD_CLOEXEC);
+  if (file == -1) {
+    throw_errno("memfd_create");
+  }
+#else
+  static std::atomic<unsigned> counter{0};
+  const std::string name = "/ptr-shm-" + std::to_string(getpid()) + "-" +
+    std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+  const int file = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (file == -1) {
+    throw_errno("shm_open");
+  }
+  // The descriptor is all that other processes need.
+  shm_unlink(name.c_str());
+#endif
+  if (ftruncate(file, off_t(size)) == -1) {
+    const int error = errno;
+    close(file);
+    errno = error;
+    throw_errno("ftruncate");
+  }
+  return file;
+}
+
+inline char *map_file(int file, std::size_t length) {
+  void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    close(file);
+    errno = error;
+    throw_errno("mmap");
+  }
+  return static_cast<char*>(base);
+}
+
+} // namespace detail
+
+struct Region::Header {
+  static constexpr std::uint64_t expected_magic = 0x7074722d73686d31; // "ptr-shm1"
+
+  std::uint64_t magic;
+  std::uint64_t length;
+  std::atomic<std::uint32_t> lock;
+  // `free_list` is the first free chunk, and `bump` is where never-allocated
+  // memory begins.
+  Offset free_list;
+  Offset bump;
+};
+
+inline Region::Region(int file, char *base, std::size_t length)
+: file(file)
+, base(base)
+, length(length) {}
+
+inline Region::Header& Region::header() const {
+  return *reinterpret_cast<Header*>(base);
+}
+
+inline Region Region::create(std::size_t size) {
+  const std::size_t length =
+    detail::round_up(sizeof(Header), max_align) + detail::round_up(size, max_align);
+  const int file = detail::create_file(length);
+  char *base = detail::map_file(file, length);
+  Header *header = new (base) Header{};
+  header->length = length;
+  header->bump = detail::round_up(sizeof(Header), max_align);
+  header->magic = Header::expected_magic;
+  return Region(file, base, length);
+}
+
+inline Region Region::open(int file) {
+  struct stat status;
+  if (fstat(file, &status) == -1) {
+    const int error = errno;
+    close(file);
+    errno = error;
+    detail::throw_errno("fstat");
+  }
+  const std::size_t length = status.st_size;
+  if (length < sizeof(Header)) {
+    close(file);
+    errno = EINVAL;
+    detail::throw_errno("ptr::shm::Region::open");
+  }
+  char *base = detail::map_file(file, length);
+  const Header& header = *reinterpret_cast<Header*>(base);
+  if (header.magic != Header::expected_magic || header.length != length) {
+    munmap(base, length);
+    close(file);
+    errno = EINVAL;
+    detail::throw_errno("ptr::shm::Region::open");
+  }
+  return Region(file, base, length);
+}
+
+inline Region::~Region() {
+  munmap(base, length);
+  close(file);
+}
+
+inline int Region::fd() const {
+  return file;
+}
+
+inline std::size_t Region::size() const {
+  return length;
+}
+
+inline void *Region::allocate(std::size_t bytes) {
+  using detail::Chunk;
+  const std::size_t needed =
+    detail::round_up(sizeof(Chunk) + std::max<std::size_t>(bytes, 1), max_align);
+  Header& head = header();
+  detail::SpinLock lock(head.lock);
+
+  // First fit from the free list, splitting off the end of a chunk that has
+  // room for another.
+  for (Offset *link = &head.free_list; *link;) {
+    Chunk *chunk = static_cast<Chunk*>(address_of(*link));
+    if (chunk->size >= needed + 2 * sizeof(Chunk)) {
+      chunk->size -= needed;
+      Chunk *tail = reinterpret_cast<Chunk*>(reinterpret_cast<char*>(chunk) + chunk->size);
+      tail->size = needed;
+      return tail + 1;
+    }
+    if (chunk->size >= needed) {
+      *link = chunk->next;
+      return chunk + 1;
+    }
+    link = &chunk->next;
+  }
+
+  if (head.bump + needed > length) {
+    throw std::bad_alloc();
+  }
+  Chunk *chunk = static_cast<Chunk*>(address_of(head.bump));
+  chunk->size = needed;
+  head.bump += needed;
+  return chunk + 1;
+}
+
+inline void Region::deallocate(void *memory) {
+  if (!memory) {
+    return;
+  }
+  using detail::Chunk;
+  Chunk *chunk = static_cast<Chunk*>(memory) - 1;
+  const Offset offset = offset_of(chunk);
+  Header& head = header();
+  detail::SpinLock lock(head.lock);
+
+  // The free list is in address order, so that a freed chunk can be merged
+  // with its free neighbours, and the region does not fragment into chunks
+  // too small to use.
+  Chunk *previous = nullptr;
+  Offset *previous_link = nullptr;
+  Offset *link = &head.free_list;
+  while (*link && *link < offset) {
+    previous_link = link;
+    previous = static_cast<Chunk*>(address_of(*link));
+    link = &previous->next;
+  }
+  chunk->next = *link;
+  *link = offset;
+
+  if (chunk->next && offset + chunk->size == chunk->next) {
+    const Chunk *following = static_cast<Chunk*>(address_of(chunk->next));
+    chunk->size += following->size;
+    chunk->next = following->next;
+  }
+  if (previous && offset_of(previous) + previous->size == offset) {
+    previous->size += chunk->size;
+    previous->next = chunk->next;
+    chunk = previous;
+    link = previous_link;
+  }
+
+  // A free chunk that ends where never-allocated memory begins is the last
+  // in the list, and goes back to the never-allocated memory.
+  if (offset_of(chunk) + chunk->size == head.bump) {
+    head.bump = offset_of(chunk);
+    *link = chunk->next;
+  }
+}
+
+inline Offset Region::offset_of(const void *address) const {
+  return address ? static_cast<const char*>(address) - base : 0;
+}
+
+inline void *Region::address_of(Offset offset) const {
+  return offset ? base + offset : nullptr;
+}
+
+template <typename Object>
+struct Shared<Object>::Block {
+  static_assert(alignof(Value) <= Region::max_align,
+                "ptr::shm objects may be aligned to at most 16 bytes");
+
+  std::atomic<std::uint32_t> strong;
+  std::uint32_t count;
+
+  static constexpr std::size_t header_size =
+    (sizeof(std::atomic<std::uint32_t>) + sizeof(std::uint32_t) + alignof(Value) - 1) /
+    alignof(Value) * alignof(Value);
+
+  static std::size_t bytes(std::size_t count) {
+    return header_size + count * sizeof(Value);
+  }
+
+  Value *elements() {
+    return reinterpret_cast<Value*>(reinterpret_cast<char*>(this) + header_size);
+  }
+};
+
+template <typename Object>
+Shared<Object>::Shared(Region *region, Block *block)
+: region(region)
+, block(block) {}
+
+template <typename Object>
+Shared<Object>::Shared()
+: region(nullptr)
+, block(nullptr) {}
+
+template <typename Object>
+Shared<Object>::Shared(const Shared& other)
+: region(other.region)
+, block(other.block) {
+  if (block) {
+    block->strong.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <typename Object>
+Shared<Object>::Shared(Shared&& other)
+: region(std::exchange(other.region, nullptr))
+, block(std::exchange(other.block, nullptr)) {}
+
+template <typename Object>
+Shared<Object>::~Shared() {
+  if (!block || block->strong.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  Value *elements = block->elements();
+  for (std::uint32_t i = block->count; i != 0; --i) {
+    elements[i - 1].~Value();
+  }
+  block->~Block();
+  region->deallocate(block);
+}
+
+template <typename Object>
+Shared<Object>& Shared<Object>::operator=(Shared other) {
+  std::swap(region, other.region);
+  std::swap(block, other.block);
+  return *this;
+}
+
+template <typename Object>
+void Shared<Object>::reset() {
+  *this = Shared();
+}
+
+template <typename Object>
+Object& Shared<Object>::operator*() const {
+  return *get();
+}
+
+template <typename Object>
+Object *Shared<Object>::operator->() const {
+  return get();
+}
+
+template <typename Object>
+Object& Shared<Object>::operator[](std::size_t index) const {
+  return get()[index];
+}
+
+template <typename Object>
+Object *Shared<Object>::get() const {
+  return block ? block->elements() : nullptr;
+}
+
+template <typename Object>
+std::size_t Shared<Object>::size() const {
+  return block ? block->count : 0;
+}
+
+template <typename Object>
+Shared<Object>::operator bool() const {
+  return block != nullptr;
+}
+
+template <typename Object>
+long Shared<Object>::use_count() const {
+  return block ? block->strong.load(std::memory_order_relaxed) : 0;
+}
+
+template <typename Object>
+Offset Shared<Object>::release() {
+  const Offset offset = block ? region->offset_of(block) : 0;
+  region = nullptr;
+  block = nullptr;
+  return offset;
+}
+
+template <typename Object>
+Shared<Object> Shared<Object>::adopt(Region& region, Offset offset) {
+  if (!offset) {
+    return Shared();
+  }
+  return Shared(&region, static_cast<Block*>(region.address_of(offset)));
+}
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared(Region& region, Args&&... args) {
+  using Block = typename Shared<Object>::Block;
+  using Value = typename Shared<Object>::Value;
+  void *memory = region.allocate(Block::bytes(1));
+  Block *block = new (memory) Block{{1}, 1};
+  try {
+    new (block->elements()) Value(std::forward<Args>(args)...);
+  } catch (...) {
+    region.deallocate(memory);
+    throw;
+  }
+  return Shared<Object>(&region, block);
+}
+
+template <typename Object>
+Shared<Object> make_shared_array(Region& region, std::size_t count) {
+  using Block = typename Shared<Object>::Block;
+  using Value = typename Shared<Object>::Value;
+  if (count > UINT32_MAX) {
+    throw std::bad_array_new_length();
+  }
+  void *memory = region.allocate(Block::bytes(count));
+  Block *block = new (memory) Block{{1}, std::uint32_t(count)};
+  Value *elements = block->elements();
+  std::size_t constructed = 0;
+  try {
+    for (; constructed < count; ++constructed) {
+      new (elements + constructed) Value();
+    }
+  } catch (...) {
+    while (constructed) {
+      elements[--constructed].~Value();
+    }
+    region.deallocate(memory);
+    throw;
+  }
+  return Shared<Object>(&region, block);
+}
+
+} // namespace ptr::shm
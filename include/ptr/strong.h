@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ptr {
+
+// `StrongShared` is a `ptr::Shared` for objects that are never observed by a
+// `ptr::Weak`, which is most of them. Its control block is a single strong
+// ref count: no weak count, no "sticky" zero, and no virtual functions, so
+// releasing a reference is one `fetch_sub`, even the last one. In exchange,
+// there is no way to make a `ptr::Weak`, or a `ptr::Shared`, from a
+// `StrongShared`; trying to is a compile-time error.
+template <typename Object>
+class StrongShared;
+
+// Return a `StrongShared` to a new `Object` constructed from `args`.
+template <typename Object, typename... Args>
+StrongShared<Object> make_shared_strong_only(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `StrongCount` is the control block of a `StrongShared`. `destroy` destroys
+// the object and frees the block, which is how a handle to a base class can
+// release a block made for a derived class without a virtual destructor.
+struct StrongCount {
+  std::atomic<std::uint32_t> strong;
+  void (*const destroy)(StrongCount*);
+
+  void increment() {
+    strong.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void decrement() {
+    if (strong.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      destroy(this);
+    }
+  }
+};
+
+template <typename Object>
+struct StrongOnlyBlock : public StrongCount {
+  alignas(Object) char storage[sizeof(Object)];
+
+  StrongOnlyBlock()
+  : StrongCount{{1}, &StrongOnlyBlock::destroy_block} {}
+
+  Object *object() {
+    return std::launder(reinterpret_cast<Object*>(storage));
+  }
+
+  static void destroy_block(StrongCount *count) {
+    auto *block = static_cast<StrongOnlyBlock*>(count);
+    block->object()->~Object();
+    delete block;
+  }
+};
+
+} // namespace detail
+
+template <typename Object>
+class StrongShared {
+  Object *object;
+  detail::StrongCount *count;
+
+  StrongShared(Object *object, detail::StrongCount *count);
+
+  template <typename Obj>
+  friend class StrongShared;
+
+  template <typename Obj, typename... Args>
+  friend StrongShared<Obj> make_shared_strong_only(Args&&...);
+
+  template <typename Obj>
+  friend void swap(StrongShared<Obj>&, StrongShared<Obj>&);
+
+ public:
+  StrongShared();
+  StrongShared(std::nullptr_t);
+  StrongShared(const StrongShared&);
+  StrongShared(StrongShared&&);
+  template <typename Other,
+            typename = std::enable_if_t<std::is_convertible_v<Other*, Object*>>>
+  StrongShared(const StrongShared<Other>&);
+  template <typename Other,
+            typename = std::enable_if_t<std::is_convertible_v<Other*, Object*>>>
+  StrongShared(StrongShared<Other>&&);
+  ~StrongShared();
+
+  StrongShared& operator=(StrongShared);
+
+  void reset();
+
+  Object& operator*() const;
+  Object *operator->() const;
+  Object *get() const;
+  explicit operator bool() const;
+
+  long use_count() const;
+  bool unique() const;
+};
+
+template <typename Object>
+void swap(StrongShared<Object>&, StrongShared<Object>&);
+
+template <typename Object>
+StrongShared<Object>::StrongShared(Object *object, detail::StrongCount *count)
+: object(object)
+, count(count) {}
+
+template <typename Object>
+StrongShared<Object>::StrongShared()
+: object(nullptr)
+, count(nullptr) {}
+
+template <typename Object>
+StrongShared<Object>::StrongShared(std::nullptr_t)
+: StrongShared() {}
+
+template <typename Object>
+StrongShared<Object>::StrongShared(const StrongShared& other)
+: object(other.object)
+, count(other.count) {
+  if (count) {
+    count->increment();
+  }
+}
+
+template <typename Object>
+StrongShared<Object>::StrongShared(StrongShared&& other)
+: object(std::exchange(other.object, nullptr))
+, count(std::exchange(other.count, nullptr)) {}
+
+template <typename Object>
+template <typename Other, typename>
+StrongShared<Object>::StrongShared(const StrongShared<Other>& other)
+: object(other.object)
+, count(other.count) {
+  if (count) {
+    count->increment();
+  }
+}
+
+template <typename Object>
+template <typename Other, typename>
+StrongShared<Object>::StrongShared(StrongShared<Other>&& other)
+: object(std::exchange(other.object, nullptr))
+, count(std::exchange(other.count, nullptr)) {}
+
+template <typename Object>
+StrongShared<Object>::~StrongShared() {
+  if (count) {
+    count->decrement();
+  }
+}
+
+template <typename Object>
+StrongShared<Object>& StrongShared<Object>::operator=(StrongShared other) {
+  swap(*this, other);
+  return *this;
+}
+
+template <typename Object>
+void StrongShared<Object>::reset() {
+  StrongShared doomed(std::move(*this));
+}
+
+template <typename Object>
+Object& StrongShared<Object>::operator*() const {
+  return *object;
+}
+
+template <typename Object>
+Object *StrongShared<Object>::operator->() const {
+  return object;
+}
+
+template <typename Object>
+Object *StrongShared<Object>::get() const {
+  return object;
+}
+
+template <typename Object>
+StrongShared<Object>::operator bool() const {
+  return object != nullptr;
+}
+
+template <typename Object>
+long StrongShared<Object>::use_count() const {
+  return count ? count->strong.load(std::memory_order_relaxed) : 0;
+}
+
+template <typename Object>
+bool StrongShared<Object>::unique() const {
+  // Acquire, for the same reason as `ptr::Shared::unique`.
+  return count && count->strong.load(std::memory_order_acquire) == 1;
+}
+
+template <typename Object>
+void swap(StrongShared<Object>& left, StrongShared<Object>& right) {
+  using std::swap;
+  swap(left.object, right.object);
+  swap(left.count, right.count);
+}
+
+template <typename Object, typename... Args>
+StrongShared<Object> make_shared_strong_only(Args&&... args) {
+  auto block = std::make_unique<detail::StrongOnlyBlock<Object>>();
+  auto *object = new (block->storage) Object(std::forward<Args>(args)...);
+  return StrongShared<Object>(object, block.release());
+}
+
+} // namespace ptr
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `TeardownPool` destroys large object graphs on several threads at once.
+// Objects in the graph must be created by `ptr::make_shared_teardown`. When
+// such an object's last strong reference is released on one of the pool's
+// threads, the object is not destroyed right away, recursively: its control
+// block is pushed onto that thread's work queue instead. Idle threads steal
+// from the others' queues, so independent subtrees are destroyed in parallel.
+// Released anywhere else, the objects are destroyed as usual.
+//
+// Hand a graph to the pool with `release`, and wait for it with `wait`.
+class TeardownPool;
+
+// Return a `ptr::Shared` to a new `Object` constructed from `args`, which a
+// `TeardownPool` may destroy in parallel with its neighbours in a graph.
+template <typename Object, typename... Args>
+Shared<Object> make_shared_teardown(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+namespace detail {
+
+// `TeardownTask` is a unit of work in a `TeardownPool`.
+struct TeardownTask {
+  // `run` takes ownership of `this`.
+  virtual void run() = 0;
+
+ protected:
+  ~TeardownTask() = default;
+};
+
+// `ReleaseTask` releases one strong reference.
+struct ReleaseTask final : public TeardownTask {
+  ControlBlock *control_block;
+
+  explicit ReleaseTask(ControlBlock *control_block)
+  : control_block(control_block) {}
+
+  void run() override {
+    ControlBlock *released = control_block;
+    delete this;
+    released->decrement_strong();
+  }
+};
+
+// `ReleaseHandleTask` releases a handle that has no control block to hand
+// over, because it is a sole owner.
+template <typename Object>
+struct ReleaseHandleTask final : public TeardownTask {
+  Shared<Object> handle;
+
+  explicit ReleaseHandleTask(Shared<Object> handle)
+  : handle(std::move(handle)) {}
+
+  void run() override {
+    delete this;
+  }
+};
+
+class TeardownWorker {
+  std::mutex mutex;
+  // The owning worker pushes and pops at the back. Thieves take from the
+  // front, where the oldest, and so likely the largest, subtrees are.
+  std::deque<TeardownTask*> tasks;
+
+ public:
+  void push(TeardownTask *task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(task);
+  }
+
+  TeardownTask *pop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty()) {
+      return nullptr;
+    }
+    TeardownTask *task = tasks.back();
+    tasks.pop_back();
+    return task;
+  }
+
+  TeardownTask *steal() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty()) {
+      return nullptr;
+    }
+    TeardownTask *task = tasks.front();
+    tasks.pop_front();
+    return task;
+  }
+};
+
+} // namespace detail
+
+class TeardownPool {
+  using TeardownTask = detail::TeardownTask;
+
+  std::vector<std::unique_ptr<detail::TeardownWorker>> workers;
+  std::vector<std::thread> threads;
+  // `queued` is the number of tasks in the workers' queues, and `outstanding`
+  // is that plus the number of tasks running.
+  std::atomic<std::size_t> queued{0};
+  std::atomic<std::size_t> outstanding{0};
+  std::atomic<std::size_t> sleepers{0};
+  std::atomic<bool> stopping{false};
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::condition_variable finished;
+
+  struct Current {
+    TeardownPool *pool;
+    detail::TeardownWorker *worker;
+  };
+
+  static Current& current();
+
+  void work(std::size_t index);
+  TeardownTask *find_task(std::size_t index);
+  void submit(detail::TeardownWorker& worker, TeardownTask *task);
+
+ public:
+  // Start `threads` worker threads.
+  explicit TeardownPool(std::size_t threads = std::thread::hardware_concurrency());
+  TeardownPool(const TeardownPool&) = delete;
+  TeardownPool& operator=(const TeardownPool&) = delete;
+  // Wait for outstanding work, and then stop the worker threads.
+  ~TeardownPool();
+
+  // Release `root` on one of the pool's threads.
+  template <typename Object>
+  void release(Shared<Object> root);
+
+  // Block until everything released so far is destroyed. This must not be
+  // called on one of the pool's threads, such as from a destructor.
+  void wait();
+
+  // If the calling thread belongs to a pool, queue `task` there and return
+  // true. Otherwise, return false.
+  static bool defer(TeardownTask *task);
+};
+
+// `TeardownControlBlock` is an `InPlaceControlBlock` whose expiry, on a
+// `TeardownPool` thread, is queued rather than done immediately.
+template <typename Object>
+struct TeardownControlBlock : public InPlaceControlBlock<Object>,
+                              public detail::TeardownTask {
+  explicit TeardownControlBlock(RefCounts counts)
+  : InPlaceControlBlock<Object>(counts) {}
+
+  void expire() override {
+    if (!TeardownPool::defer(this)) {
+      InPlaceControlBlock<Object>::expire();
+    }
+  }
+
+  void run() override {
+    InPlaceControlBlock<Object>::expire();
+  }
+};
+
+inline TeardownPool::Current& TeardownPool::current() {
+  thread_local Current current{nullptr, nullptr};
+  return current;
+}
+
+inline TeardownPool::TeardownPool(std::size_t thread_count) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    workers.push_back(std::make_unique<detail::TeardownWorker>());
+  }
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([this, i]() { work(i); });
+  }
+}
+
+inline TeardownPool::~TeardownPool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+template <typename Object>
+void TeardownPool::release(Shared<Object> root) {
+  if (root.use_count() && !HandleAccess::existing_control_block(root)) {
+    submit(*workers[0], new detail::ReleaseHandleTask<Object>(std::move(root)));
+    return;
+  }
+  if (ControlBlock *control_block = HandleAccess::release(root)) {
+    submit(*workers[0], new detail::ReleaseTask(control_block));
+  }
+}
+
+inline void TeardownPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this]() {
+    return outstanding.load(std::memory_order_acquire) == 0;
+  });
+}
+
+inline bool TeardownPool::defer(TeardownTask *task) {
+  const Current& here = current();
+  if (!here.pool) {
+    return false;
+  }
+  here.pool->submit(*here.worker, task);
+  return true;
+}
+
+inline void TeardownPool::submit(detail::TeardownWorker& worker, TeardownTask *task) {
+  outstanding.fetch_add(1, std::memory_order_relaxed);
+  worker.push(task);
+  queued.fetch_add(1);
+  // A sleeper counts itself before checking `queued`, and we count the task
+  // before checking for sleepers, so one of us sees the other.
+  if (sleepers.load()) {
+    { std::lock_guard<std::mutex> lock(mutex); }
+    work_available.notify_one();
+  }
+}
+
+inline TeardownPool::TeardownTask *TeardownPool::find_task(std::size_t index) {
+  if (TeardownTask *task = workers[index]->pop()) {
+    return task;
+  }
+  for (std::size_t i = 1; i < workers.size(); ++i) {
+    if (TeardownTask *task = workers[(index + i) % workers.size()]->steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+inline void TeardownPool::work(std::size_t index) {
+  current() = Current{this, workers[index].get()};
+  for (;;) {
+    if (TeardownTask *task = find_task(index)) {
+      queued.fetch_sub(1, std::memory_order_relaxed);
+      task->run();
+      if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        finished.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    sleepers.fetch_add(1);
+    work_available.wait(lock, [this]() {
+      return stopping.load() || queued.load() != 0;
+    });
+    sleepers.fetch_sub(1);
+    if (stopping.load() && queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+template <typename Object, typename... Args>
+Shared<Object> make_shared_teardown(Args&&... args) {
+  auto control_block = std::make_unique<TeardownControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0});
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return HandleAccess::adopt(object, control_block.release());
+}
+
+} // namespace ptr
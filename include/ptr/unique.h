@@ -0,0 +1,125 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ptr {
+
+// `Unique` is a sole owner of an object, like `std::unique_ptr`, that can
+// later become a `ptr::Shared` for free. `ptr::make_unique_shareable` puts
+// the object in a control block up front, with the strong ref count already
+// at one, but a `Unique` never touches the counts: moving it is copying two
+// pointers, and destroying it destroys the object and frees the block
+// directly. `ptr::Shared<Object>(std::move(unique))` hands the block over
+// as is, so the first atomic operation on the counts is the first copy of
+// the `ptr::Shared`.
+template <typename Object>
+class Unique {
+  Object *object;
+  ControlBlock *control_block;
+
+  Unique(Object *object, ControlBlock *control_block);
+
+  template <typename Obj, typename... Args>
+  friend Unique<Obj> make_unique_shareable(Args&&...);
+
+  template <typename Obj>
+  friend class Shared;
+
+ public:
+  Unique();
+  Unique(const Unique&) = delete;
+  Unique(Unique&&);
+  ~Unique();
+
+  Unique& operator=(const Unique&) = delete;
+  Unique& operator=(Unique&&);
+
+  void reset();
+
+  Object& operator*() const;
+  Object *operator->() const;
+  Object *get() const;
+  explicit operator bool() const;
+};
+
+// Return a `Unique` that owns a new `Object` constructed from `args`.
+template <typename Object, typename... Args>
+Unique<Object> make_unique_shareable(Args&&... args);
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Object>
+Unique<Object>::Unique(Object *object, ControlBlock *control_block)
+: object(object)
+, control_block(control_block) {}
+
+template <typename Object>
+Unique<Object>::Unique()
+: object(nullptr)
+, control_block(nullptr) {}
+
+template <typename Object>
+Unique<Object>::Unique(Unique&& other)
+: object(std::exchange(other.object, nullptr))
+, control_block(std::exchange(other.control_block, nullptr)) {}
+
+template <typename Object>
+Unique<Object>::~Unique() {
+  if (control_block) {
+    // Nobody else can see the counts, so skip them.
+    control_block->destroy_object();
+    delete control_block;
+  }
+}
+
+template <typename Object>
+Unique<Object>& Unique<Object>::operator=(Unique&& other) {
+  if (this != &other) {
+    Unique doomed(std::move(*this));
+    object = std::exchange(other.object, nullptr);
+    control_block = std::exchange(other.control_block, nullptr);
+  }
+  return *this;
+}
+
+template <typename Object>
+void Unique<Object>::reset() {
+  Unique doomed(std::move(*this));
+}
+
+template <typename Object>
+Object& Unique<Object>::operator*() const {
+  return *object;
+}
+
+template <typename Object>
+Object *Unique<Object>::operator->() const {
+  return object;
+}
+
+template <typename Object>
+Object *Unique<Object>::get() const {
+  return object;
+}
+
+template <typename Object>
+Unique<Object>::operator bool() const {
+  return object != nullptr;
+}
+
+template <typename Object, typename... Args>
+Unique<Object> make_unique_shareable(Args&&... args) {
+  auto control_block = std::make_unique<InPlaceControlBlock<Object>>(
+    RefCounts{.strong = 1, .weak = 0});
+  auto *object = new (control_block->storage) Object(std::forward<Args>(args)...);
+  return Unique<Object>(object, control_block.release());
+}
+
+} // namespace ptr
@@ -3,6 +3,11 @@
 #include <ptr/detail/control_block.h>
 #include <ptr/shared.h>
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
 namespace ptr {
 
 template <typename Object>
@@ -13,18 +18,33 @@ class Weak {
   template <typename Other>
   friend class Weak;
 
+  template <typename Obj>
+  friend void swap(Weak<Obj>&, Weak<Obj>&);
+
+  friend struct HandleAccess;
+
+  template <typename Other>
+  Weak& copy_assign(const Weak<Other>&);
+  template <typename Other>
+  Weak& move_assign(Weak<Other>&&);
+
  public:
+  Weak();
   template <typename Other>
   explicit Weak(const Shared<Other>&);
+  Weak(const Weak&);
   template <typename Other>
   explicit Weak(const Weak<Other>&);
+  Weak(Weak&&);
   template <typename Other>
   explicit Weak(Weak<Other>&&);
    
   ~Weak();
    
+  Weak& operator=(const Weak&);
   template <typename Other>
   Weak& operator=(const Weak<Other>&);
+  Weak& operator=(Weak&&);
   template <typename Other>
   Weak& operator=(Weak<Other>&&);
   template <typename Other>
@@ -33,6 +53,19 @@ class Weak {
   void reset();
 
   Shared<Object> lock() const;
+
+  bool expired() const;
+  long use_count() const;
+
+  template <typename Other>
+  bool owner_before(const Shared<Other>&) const;
+  template <typename Other>
+  bool owner_before(const Weak<Other>&) const;
+  template <typename Other>
+  bool owner_equal(const Shared<Other>&) const;
+  template <typename Other>
+  bool owner_equal(const Weak<Other>&) const;
+  std::size_t owner_hash() const;
 };
 
 template <typename Object>
@@ -42,10 +75,26 @@ void swap(Weak<Object>&, Weak<Object>&);
 // Implementation
 // --------------
 
+template <typename Object>
+Weak<Object>::Weak()
+: object(nullptr)
+, control_block(nullptr) {}
+
 template <typename Object>
 template <typename Other>
 Weak<Object>::Weak(const Shared<Other>& other)
 : object(other.object)
+, control_block(other.shared_control_block()) {
+  if (!control_block) {
+    return;
+  }
+
+  control_block->increment_weak();
+}
+
+template <typename Object>
+Weak<Object>::Weak(const Weak<Object>& other)
+: object(other.object)
 , control_block(other.control_block) {
   if (!control_block) {
     return;
@@ -66,6 +115,14 @@ Weak<Object>::Weak(const Weak<Other>& other)
   control_block->increment_weak();
 }
 
+template <typename Object>
+Weak<Object>::Weak(Weak<Object>&& other)
+: object(other.object)
+, control_block(other.control_block) {
+  other.object = nullptr;
+  other.control_block = nullptr;
+}
+
 template <typename Object>
 template <typename Other>
 Weak<Object>::Weak(Weak<Other>&& other)
@@ -85,7 +142,7 @@ Weak<Object>::~Weak() {
 
 template <typename Object>
 template <typename Other>
-Weak<Object>& Weak<Object>::operator=(const Weak<Other>& other) {
+Weak<Object>& Weak<Object>::copy_assign(const Weak<Other>& other) {
   if (control_block != other.control_block) {
     if (control_block) {
       control_block->decrement_weak();
@@ -102,12 +159,14 @@ Weak<Object>& Weak<Object>::operator=(const Weak<Other>& other) {
 
 template <typename Object>
 template <typename Other>
-Weak<Object>& Weak<Object>::operator=(Weak<Other>&& other) {
-  if (this == &other) {
+Weak<Object>& Weak<Object>::move_assign(Weak<Other>&& other) {
+  if (static_cast<void*>(this) == static_cast<void*>(&other)) {
     return *this;
   }
 
-  if (control_block && control_block != other.control_block) {
+  // `other`'s weak reference is transferred to `*this`, so the one we held
+  // must be released even if it refers to the same control block.
+  if (control_block) {
     control_block->decrement_weak();
   }
 
@@ -120,17 +179,40 @@ Weak<Object>& Weak<Object>::operator=(Weak<Other>&& other) {
   return *this;
 }
 
+template <typename Object>
+Weak<Object>& Weak<Object>::operator=(const Weak<Object>& other) {
+  return copy_assign(other);
+}
+
+template <typename Object>
+template <typename Other>
+Weak<Object>& Weak<Object>::operator=(const Weak<Other>& other) {
+  return copy_assign(other);
+}
+
+template <typename Object>
+Weak<Object>& Weak<Object>::operator=(Weak<Object>&& other) {
+  return move_assign(std::move(other));
+}
+
+template <typename Object>
+template <typename Other>
+Weak<Object>& Weak<Object>::operator=(Weak<Other>&& other) {
+  return move_assign(std::move(other));
+}
+
 template <typename Object>
 template <typename Other>
 Weak<Object>& Weak<Object>::operator=(const Shared<Other>& other) {
-  if (control_block != other.control_block) {
+  ControlBlock *other_control_block = other.shared_control_block();
+  if (control_block != other_control_block) {
     if (control_block) {
       control_block->decrement_weak();
     }
-    if (other.control_block) {
-      other.control_block->increment_weak();
+    if (other_control_block) {
+      other_control_block->increment_weak();
     }
-    control_block = other.control_block;
+    control_block = other_control_block;
   }
   object = other.object;
   
@@ -152,20 +234,64 @@ Shared<Object> Weak<Object>::lock() const {
     return Shared<Object>{};
   }
 
-  // Increment the strong ref count, but only if it's not currently zero.
-  std::uint64_t expected = control_block->ref_counts.load();
-  RefCounts desired;
-  do {
-    desired = RefCounts::from_word(expected);
-    if (desired.strong) {
-      ++desired.strong;
-    }
-  } while (!control_block->ref_counts.compare_exchange_weak(expected, desired.as_word()));
-
-  if (desired.strong) {
+  // Increment the strong ref count, but only if the object is alive.
+  if (control_block->try_increment_strong()) {
     return Shared<Object>{object, control_block};
   }
   return Shared<Object>{};
 }
 
+// `expired` and `use_count` are (almost always) plain loads, so they are much
+// cheaper than `lock` when the caller only needs to know whether the object is
+// alive.
+template <typename Object>
+bool Weak<Object>::expired() const {
+  return !control_block ||
+    control_block->strong_count(std::memory_order_acquire) == 0;
+}
+
+template <typename Object>
+long Weak<Object>::use_count() const {
+  if (!control_block) {
+    return 0;
+  }
+  return control_block->strong_count();
+}
+
+template <typename Object>
+template <typename Other>
+bool Weak<Object>::owner_before(const Shared<Other>& other) const {
+  return std::less<ControlBlock*>{}(control_block, HandleAccess::control_block(other));
+}
+
+template <typename Object>
+template <typename Other>
+bool Weak<Object>::owner_before(const Weak<Other>& other) const {
+  return std::less<ControlBlock*>{}(control_block, HandleAccess::control_block(other));
+}
+
+template <typename Object>
+template <typename Other>
+bool Weak<Object>::owner_equal(const Shared<Other>& other) const {
+  return control_block == HandleAccess::control_block(other);
+}
+
+template <typename Object>
+template <typename Other>
+bool Weak<Object>::owner_equal(const Weak<Other>& other) const {
+  return control_block == HandleAccess::control_block(other);
+}
+
+template <typename Object>
+std::size_t Weak<Object>::owner_hash() const {
+  return std::hash<ControlBlock*>{}(control_block);
+}
+
+template <typename Object>
+void swap(Weak<Object>& left, Weak<Object>& right) {
+  using std::swap;
+  swap(left.object, right.object);
+  swap(left.control_block, right.control_block);
+}
+
 } // namespace ptr
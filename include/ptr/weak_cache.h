@@ -0,0 +1,201 @@
+#pragma once
+
+#include <ptr/detail/control_block.h>
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ptr {
+
+// `WeakCache` is a concurrent "get or create" cache of `ptr::Shared<Value>`
+// keyed by `Key`. The cache holds only `ptr::Weak` references, so it does not
+// keep values alive. Values are created by the cache itself, in a control
+// block that removes the value's entry from the cache when the value's strong
+// ref count reaches zero, so dead entries never need to be swept.
+// Concurrent requests for the same missing key invoke the factory only once;
+// the other requesters wait for its result.
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class WeakCache {
+  struct Shard;
+  struct Entry;
+  struct CachedControlBlock;
+
+  std::vector<Shared<Shard>> shards;
+  Hash hash;
+
+  Shard& shard_for(const Key&) const;
+
+ public:
+  explicit WeakCache(std::size_t shard_count = 16);
+
+  // Return the value associated with `key` if it is alive. Otherwise, create
+  // the value from the result of `factory()`, associate it with `key`, and
+  // return it. If `factory` throws, the exception propagates and no value is
+  // associated with `key`.
+  template <typename Factory>
+  Shared<Value> get_or_create(const Key& key, Factory&& factory);
+
+  // Return the value associated with `key` if it is alive, or return an empty
+  // `ptr::Shared` otherwise.
+  Shared<Value> find(const Key& key) const;
+
+  // Return the number of keys currently associated with values, including
+  // values that are being created.
+  std::size_t size() const;
+};
+
+// --------------
+// Implementation
+// --------------
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+struct WeakCache<Key, Value, Hash, Equal>::Entry {
+  Weak<Value> value;
+  // `pending` is true while some thread is creating the value. Other threads
+  // wait on `Shard::created` until it becomes false.
+  bool pending = false;
+};
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+struct WeakCache<Key, Value, Hash, Equal>::Shard {
+  std::mutex mutex;
+  std::condition_variable created;
+  std::unordered_map<Key, Entry, Hash, Equal> entries;
+
+  // Remove the entry for `key`, but only if it still refers to the value
+  // managed by `control_block`. The entry might instead be pending, or refer
+  // to a newer value that replaced the dead one.
+  void purge(const Key& key, ControlBlock *control_block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key);
+    if (found == entries.end() || found->second.pending ||
+        HandleAccess::control_block(found->second.value) != control_block) {
+      return;
+    }
+    entries.erase(found);
+  }
+};
+
+// `CachedControlBlock` is an `InPlaceControlBlock` that remembers which cache
+// entry refers to it, and purges that entry when the value expires.
+// It holds a strong reference to its shard so that values may outlive the
+// cache. That reference is dropped on expiry, which breaks the cycle between
+// the shard's weak entries and the shard itself.
+template <typename Key, typename Value, typename Hash, typename Equal>
+struct WeakCache<Key, Value, Hash, Equal>::CachedControlBlock
+: public InPlaceControlBlock<Value> {
+  Shared<Shard> shard;
+  Key key;
+
+  CachedControlBlock(const Shared<Shard>& shard, const Key& key)
+  : InPlaceControlBlock<Value>(RefCounts{.strong = 1, .weak = 0})
+  , shard(shard)
+  , key(key) {}
+
+  void expire() override {
+    shard->purge(key, this);
+    shard.reset();
+    InPlaceControlBlock<Value>::expire();
+  }
+};
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+WeakCache<Key, Value, Hash, Equal>::WeakCache(std::size_t shard_count) {
+  if (shard_count == 0) {
+    shard_count = 1;
+  }
+  shards.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    shards.push_back(make_shared<Shard>());
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+typename WeakCache<Key, Value, Hash, Equal>::Shard&
+WeakCache<Key, Value, Hash, Equal>::shard_for(const Key& key) const {
+  return *shards[hash(key) % shards.size()];
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+template <typename Factory>
+Shared<Value> WeakCache<Key, Value, Hash, Equal>::get_or_create(
+    const Key& key, Factory&& factory) {
+  const Shared<Shard>& shard = shards[hash(key) % shards.size()];
+  std::unique_lock<std::mutex> lock(shard->mutex);
+
+  Entry *entry;
+  for (;;) {
+    auto [iter, inserted] = shard->entries.try_emplace(key);
+    entry = &iter->second;
+    if (inserted) {
+      break;
+    }
+    if (entry->pending) {
+      shard->created.wait(lock);
+      continue;
+    }
+    if (Shared<Value> value = entry->value.lock(); value.get()) {
+      return value;
+    }
+    // The entry's value is dead, but its control block has not purged it
+    // yet. Replace it.
+    break;
+  }
+
+  // We are the creator. References to elements of an `std::unordered_map`
+  // remain valid across rehashing, and nobody else removes a pending entry,
+  // so `entry` is still valid once we reacquire the lock.
+  entry->pending = true;
+  lock.unlock();
+
+  Shared<Value> value;
+  try {
+    auto control_block = std::make_unique<CachedControlBlock>(shard, key);
+    auto *object = new (control_block->storage) Value(
+        std::forward<Factory>(factory)());
+    value = HandleAccess::adopt(object, control_block.release());
+  } catch (...) {
+    lock.lock();
+    shard->entries.erase(key);
+    shard->created.notify_all();
+    throw;
+  }
+
+  lock.lock();
+  entry->value = value;
+  entry->pending = false;
+  shard->created.notify_all();
+  return value;
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+Shared<Value> WeakCache<Key, Value, Hash, Equal>::find(const Key& key) const {
+  Shard& shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.entries.find(key);
+  if (found == shard.entries.end() || found->second.pending) {
+    return Shared<Value>{};
+  }
+  return found->second.value.lock();
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal>
+std::size_t WeakCache<Key, Value, Hash, Equal>::size() const {
+  std::size_t total = 0;
+  for (const Shared<Shard>& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    total += shard->entries.size();
+  }
+  return total;
+}
+
+} // namespace ptr
@@ -0,0 +1,96 @@
+#include <catch.hpp>
+
+#include <ptr/affinity.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Resource {
+  static inline std::atomic<int> alive{0};
+
+  std::thread::id *destroyed_on;
+
+  explicit Resource(std::thread::id *destroyed_on)
+  : destroyed_on(destroyed_on) {
+    ++alive;
+  }
+
+  ~Resource() {
+    *destroyed_on = std::this_thread::get_id();
+    --alive;
+  }
+};
+
+} // namespace
+
+TEST_CASE("objects released elsewhere are destroyed by the owner's drain") {
+  std::atomic<int> wakes{0};
+  ptr::DestructionQueue queue([&]() { ++wakes; });
+  std::thread::id destroyed_on;
+  std::vector<std::thread::id> many(10);
+
+  auto resource = ptr::make_shared_on<Resource>(queue, &destroyed_on);
+  ptr::Weak<Resource> weak{resource};
+  std::vector<ptr::Shared<Resource>> others;
+  for (auto& id : many) {
+    others.push_back(ptr::make_shared_on<Resource>(queue, &id));
+  }
+
+  std::thread([resource = std::move(resource), others = std::move(others)]() mutable {
+    resource.reset();
+    others.clear();
+  }).join();
+  REQUIRE(weak.expired());
+  REQUIRE(Resource::alive == 11);
+  REQUIRE(!queue.empty());
+  REQUIRE(wakes == 1);
+
+  REQUIRE(queue.drain() == 11);
+  REQUIRE(Resource::alive == 0);
+  REQUIRE(destroyed_on == std::this_thread::get_id());
+  for (const auto& id : many) {
+    REQUIRE(id == std::this_thread::get_id());
+  }
+  REQUIRE(queue.empty());
+  REQUIRE(queue.drain() == 0);
+}
+
+TEST_CASE("objects released on the owner thread are destroyed immediately") {
+  ptr::DestructionQueue queue;
+  std::thread::id destroyed_on;
+  auto resource = ptr::make_shared_on<Resource>(queue, &destroyed_on);
+  resource.reset();
+  REQUIRE(Resource::alive == 0);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("objects may be queued while the owner drains") {
+  std::atomic<int> wakes{0};
+  ptr::DestructionQueue queue([&]() { ++wakes; });
+  constexpr int count = 2000;
+  std::vector<std::thread::id> ids(count);
+  std::vector<ptr::Shared<Resource>> resources;
+  for (auto& id : ids) {
+    resources.push_back(ptr::make_shared_on<Resource>(queue, &id));
+  }
+
+  std::atomic<bool> done{false};
+  std::thread releaser([&]() {
+    resources.clear();
+    done = true;
+  });
+  int drained = 0;
+  while (!done) {
+    drained += queue.drain();
+  }
+  releaser.join();
+  drained += queue.drain();
+
+  REQUIRE(drained == count);
+  REQUIRE(Resource::alive == 0);
+  REQUIRE(wakes >= 1);
+}
@@ -0,0 +1,56 @@
+#include <catch.hpp>
+
+#include <ptr/arena.h>
+#include <ptr/handle32.h>
+#include <ptr/notify.h>
+#include <ptr/pool.h>
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+struct alignas(64) CacheLine {
+  std::uint64_t words[8] = {};
+};
+
+struct alignas(256) Page {
+  char bytes[512] = {};
+};
+
+template <typename Object>
+bool aligned(const Object *object) {
+  return reinterpret_cast<std::uintptr_t>(object) % alignof(Object) == 0;
+}
+
+} // namespace
+
+// Under AddressSanitizer, these also check that each block is freed with the
+// size and alignment that it was allocated with.
+TEMPLATE_TEST_CASE("over-aligned objects are aligned in every kind of block",
+                   "", CacheLine, Page) {
+  std::vector<ptr::Shared<TestType>> objects;
+  for (int i = 0; i < 8; ++i) {
+    objects.push_back(ptr::make_shared<TestType>());
+    objects.push_back(ptr::make_shared_notifying<TestType>());
+    objects.push_back(ptr::Shared<TestType>(new TestType));
+  }
+  ptr::Pool<TestType> pool(3);
+  ptr::Arena arena(1000);
+  for (int i = 0; i < 8; ++i) {
+    objects.push_back(pool.make_shared());
+    objects.push_back(arena.make_shared<TestType>());
+  }
+  for (const auto& object : objects) {
+    REQUIRE(aligned(object.get()));
+  }
+
+  ptr::Weak<TestType> weak{objects.front()};
+  objects.clear();
+  REQUIRE(weak.expired());
+
+  auto handle = ptr::make_handle32<TestType>();
+  REQUIRE(aligned(handle.get()));
+}
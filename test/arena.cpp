@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <ptr/arena.h>
+#include <ptr/weak.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Node {
+  static inline int alive = 0;
+
+  std::string name;
+  std::vector<ptr::Shared<Node>> children;
+
+  explicit Node(std::string name)
+  : name(std::move(name)) {
+    ++alive;
+  }
+
+  ~Node() { --alive; }
+};
+
+struct alignas(64) Wide {
+  char bytes[64];
+};
+
+} // namespace
+
+TEST_CASE("arena objects are destroyed as usual and freed in bulk") {
+  ptr::Weak<Node> observer;
+  ptr::Shared<Node> survivor;
+  {
+    ptr::Arena arena(1024);
+    auto root = arena.make_shared<Node>("root");
+    for (int i = 0; i < 100; ++i) {
+      root->children.push_back(arena.make_shared<Node>(std::to_string(i)));
+    }
+    REQUIRE(arena.bytes_allocated() > 100 * sizeof(Node));
+    observer = root->children[0];
+    survivor = root->children[99];
+
+    root->children.pop_back();
+    REQUIRE(Node::alive == 101);
+    root.reset();
+    REQUIRE(Node::alive == 1);
+    REQUIRE(observer.expired());
+  }
+  REQUIRE(survivor->name == "99");
+  std::thread([survivor = std::move(survivor)]() {}).join();
+  REQUIRE(Node::alive == 0);
+}
+
+TEST_CASE("arena respects alignment and oversized objects") {
+  ptr::Arena arena(256);
+  for (int i = 0; i < 10; ++i) {
+    auto wide = arena.make_shared<Wide>();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(wide.get()) % 64 == 0);
+  }
+  auto big = arena.make_shared<std::vector<char>>(std::size_t(1000));
+  auto huge = arena.make_shared<std::array<char, 4096>>();
+  REQUIRE(big->size() == 1000);
+  huge->fill('x');
+}
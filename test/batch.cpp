@@ -0,0 +1,146 @@
+#include <catch.hpp>
+
+#include <ptr/batch.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Counted {
+  static inline int alive = 0;
+  int id;
+
+  explicit Counted(int id) : id(id) { ++alive; }
+  ~Counted() { --alive; }
+};
+
+// `FailingOutput` is an output iterator whose assignments throw once
+// `*successes` of them have gone through.
+struct FailingOutput {
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = void;
+
+  std::vector<ptr::Shared<Counted>> *sink;
+  int *successes;
+
+  FailingOutput& operator*() { return *this; }
+  FailingOutput& operator++() { return *this; }
+  FailingOutput operator++(int) { return *this; }
+
+  FailingOutput& operator=(ptr::Shared<Counted>&& handle) {
+    if ((*successes)-- == 0) {
+      throw std::runtime_error("output failed");
+    }
+    sink->push_back(std::move(handle));
+    return *this;
+  }
+};
+
+} // namespace
+
+TEST_CASE("copy_n_shared and destroy_n_shared adjust counts in bulk") {
+  auto first = ptr::make_shared<Counted>(1);
+  auto second = ptr::make_shared<Counted>(2);
+  std::vector<ptr::Shared<Counted>> handles{first, first, second, ptr::Shared<Counted>{},
+                                            first, second};
+
+  std::vector<ptr::Shared<Counted>> copies;
+  ptr::copy_n_shared(handles.begin(), handles.size(), std::back_inserter(copies));
+  REQUIRE(copies.size() == handles.size());
+  REQUIRE(first.use_count() == 7);
+  REQUIRE(second.use_count() == 5);
+  for (std::size_t i = 0; i < handles.size(); ++i) {
+    REQUIRE(copies[i].get() == handles[i].get());
+  }
+
+  ptr::destroy_n_shared(copies.begin(), copies.size());
+  for (const auto& copy : copies) {
+    REQUIRE(copy.get() == nullptr);
+  }
+  REQUIRE(first.use_count() == 4);
+  REQUIRE(second.use_count() == 3);
+
+  ptr::Weak<Counted> observer{second};
+  second.reset();
+  first.reset();
+  ptr::destroy_n_shared(handles.begin(), handles.size());
+  REQUIRE(Counted::alive == 0);
+  REQUIRE(observer.expired());
+}
+
+TEST_CASE("shared vector fans out and releases in batches") {
+  auto object = ptr::make_shared<Counted>(3);
+  {
+    ptr::SharedVector<Counted> subscribers(1000, object);
+    REQUIRE(subscribers.size() == 1000);
+    REQUIRE(object.use_count() == 1001);
+    REQUIRE(subscribers[999].get() == object.get());
+
+    subscribers.append(24, object);
+    subscribers.push_back(ptr::make_shared<Counted>(4));
+    REQUIRE(Counted::alive == 2);
+
+    ptr::SharedVector<Counted> copy = subscribers;
+    REQUIRE(object.use_count() == 2049);
+    copy = ptr::SharedVector<Counted>(2, object);
+    REQUIRE(object.use_count() == 1027);
+
+    subscribers.clear();
+    REQUIRE(Counted::alive == 1);
+    REQUIRE(object.use_count() == 3);
+  }
+  REQUIRE(object.use_count() == 1);
+  object.reset();
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("copy_n_shared gives back references when the output throws") {
+  std::vector<ptr::Shared<Counted>> sources;
+  for (int i = 0; i < 4; ++i) {
+    sources.push_back(ptr::make_shared<Counted>(i));
+  }
+  sources.push_back(sources[0]);
+
+  std::vector<ptr::Shared<Counted>> copies;
+  int successes = 2;
+  REQUIRE_THROWS_AS(ptr::copy_n_shared(sources.begin(), sources.size(),
+                                       FailingOutput{&copies, &successes}),
+                    std::runtime_error);
+  REQUIRE(copies.size() == 2);
+  REQUIRE(sources[0].use_count() == 3);
+  REQUIRE(sources[1].use_count() == 2);
+  REQUIRE(sources[2].use_count() == 1);
+  REQUIRE(sources[3].use_count() == 1);
+
+  copies.clear();
+  sources.clear();
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("destroy_n_shared destroys sole owners in place") {
+  auto shared = ptr::make_shared<Counted>(1);
+  std::vector<ptr::Shared<Counted>> handles;
+  // Reserve, so that the handles are not copied, and so shared, as they grow.
+  handles.reserve(3);
+  handles.emplace_back(new Counted(2));
+  handles.push_back(shared);
+  handles.emplace_back(new Counted(3));
+  REQUIRE(!ptr::HandleAccess::existing_control_block(handles[0]));
+
+  ptr::destroy_n_shared(handles.begin(), handles.size());
+  for (const auto& handle : handles) {
+    REQUIRE(handle.get() == nullptr);
+  }
+  REQUIRE(Counted::alive == 1);
+  REQUIRE(shared.use_count() == 1);
+  shared.reset();
+  REQUIRE(Counted::alive == 0);
+}
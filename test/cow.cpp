@@ -0,0 +1,59 @@
+#include <catch.hpp>
+
+#include <ptr/cow.h>
+#include <ptr/weak.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("cow copies only when mutating a shared object") {
+  ptr::Cow<std::vector<int>> original(std::in_place, 3, 7);
+  const std::vector<int> *storage = original.get();
+
+  // An unshared object is modified in place.
+  original.mutate().push_back(8);
+  REQUIRE(original.get() == storage);
+
+  ptr::Cow<std::vector<int>> copy = original;
+  REQUIRE(copy.get() == original.get());
+
+  copy.mutate()[0] = 0;
+  REQUIRE(copy.get() != original.get());
+  REQUIRE(*original == std::vector<int>{7, 7, 7, 8});
+  REQUIRE(*copy == std::vector<int>{0, 7, 7, 8});
+
+  // Now that `copy` went its own way, `original` is unshared again.
+  original.mutate().pop_back();
+  REQUIRE(original.get() == storage);
+}
+
+TEST_CASE("cow treats shared and weak references as sharing") {
+  ptr::Cow<std::string> value(std::string("hello"));
+
+  ptr::Shared<const std::string> shared = value.share();
+  value.mutate() += ", world";
+  REQUIRE(*shared == "hello");
+  REQUIRE(*value == "hello, world");
+
+  ptr::Weak<const std::string> weak{value.share()};
+  value.mutate() += "!";
+  REQUIRE(weak.expired());
+  REQUIRE(*value == "hello, world!");
+}
+
+TEST_CASE("cow keeps its value when moved from") {
+  ptr::Cow<std::string> original(std::string("value"));
+  ptr::Cow<std::string> moved = std::move(original);
+  REQUIRE(*original == "value");
+  REQUIRE(*moved == "value");
+
+  original.mutate() += "!";
+  REQUIRE(*original == "value!");
+  REQUIRE(*moved == "value");
+
+  moved = std::move(original);
+  REQUIRE(*original == "value!");
+  moved.mutate().clear();
+  REQUIRE(*original == "value!");
+}
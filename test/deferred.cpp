@@ -0,0 +1,75 @@
+#include <catch.hpp>
+
+#include <ptr/deferred.h>
+#include <ptr/weak.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Counted {
+  static inline thread_local int alive = 0;
+
+  Counted() { ++alive; }
+  ~Counted() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("local references defer their release until a flush") {
+  ptr::flush_deferred();
+  ptr::Weak<Counted> observer;
+  {
+    ptr::DeferredScope scope;
+    auto object = ptr::make_shared<Counted>();
+    observer = object;
+
+    ptr::LocalShared<Counted> local{object};
+    object.reset();
+    REQUIRE(observer.use_count() == 1);
+
+    std::vector<ptr::LocalShared<Counted>> copies(100, local);
+    ptr::LocalShared<const Counted> converted = local;
+    REQUIRE(observer.use_count() == 1);
+    REQUIRE(ptr::deferred_entries() == 1);
+
+    copies.clear();
+    converted.reset();
+    local.reset();
+    // The object outlives its last reference until the flush.
+    REQUIRE(Counted::alive == 1);
+    REQUIRE(!observer.expired());
+  }
+  REQUIRE(Counted::alive == 0);
+  REQUIRE(observer.expired());
+  REQUIRE(ptr::deferred_entries() == 0);
+}
+
+TEST_CASE("live local references survive a flush") {
+  auto object = ptr::make_shared<Counted>();
+  ptr::LocalShared<Counted> local{object};
+  object.reset();
+  ptr::flush_deferred();
+  REQUIRE(Counted::alive == 1);
+
+  ptr::Shared<Counted> shared = local.share();
+  std::thread([shared]() { REQUIRE(shared.get() != nullptr); }).join();
+  REQUIRE(shared.use_count() == 2);
+
+  local.reset();
+  ptr::flush_deferred();
+  REQUIRE(Counted::alive == 1);
+  shared.reset();
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("the deferred buffer flushes itself when enough entries are idle") {
+  ptr::flush_deferred();
+  for (int i = 0; i < 3000; ++i) {
+    ptr::LocalShared<Counted> local{ptr::make_shared<Counted>()};
+  }
+  REQUIRE(Counted::alive < 1024);
+  ptr::flush_deferred();
+  REQUIRE(Counted::alive == 0);
+}
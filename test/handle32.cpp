@@ -0,0 +1,87 @@
+#include <catch.hpp>
+
+#include <ptr/handle32.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Counted {
+  static inline std::atomic<int> alive{0};
+
+  int value;
+
+  explicit Counted(int value)
+  : value(value) {
+    ++alive;
+  }
+
+  ~Counted() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("handle32 is four bytes and counts references") {
+  static_assert(sizeof(ptr::Handle32<std::string>) == 4);
+  static_assert(sizeof(ptr::WeakHandle32<std::string>) == 4);
+
+  ptr::Handle32<Counted> handle = ptr::make_handle32<Counted>(5);
+  REQUIRE(handle->value == 5);
+  REQUIRE(handle.use_count() == 1);
+  {
+    ptr::Handle32<const Counted> copy = handle;
+    REQUIRE(copy.get() == handle.get());
+    REQUIRE(handle.use_count() == 2);
+  }
+  REQUIRE(handle.use_count() == 1);
+
+  const int before = Counted::alive;
+  handle.reset();
+  REQUIRE(!handle);
+  REQUIRE(Counted::alive == before - 1);
+}
+
+TEST_CASE("weak handle32 does not lock a reused slot") {
+  auto handle = ptr::make_handle32<Counted>(1);
+  ptr::WeakHandle32<Counted> weak{handle};
+  REQUIRE(!weak.expired());
+  REQUIRE(weak.lock()->value == 1);
+
+  Counted *slot = handle.get();
+  handle.reset();
+  REQUIRE(weak.expired());
+  REQUIRE(!weak.lock());
+
+  // The freed slot is the next one allocated, but in a new generation.
+  auto replacement = ptr::make_handle32<Counted>(2);
+  REQUIRE(replacement.get() == slot);
+  REQUIRE(weak.expired());
+  REQUIRE(!weak.lock());
+  REQUIRE(ptr::WeakHandle32<Counted>{replacement}.lock()->value == 2);
+}
+
+TEST_CASE("handle32 arenas grow and are shared between threads") {
+  std::vector<std::thread> threads;
+  std::atomic<bool> failed{false};
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&failed, t]() {
+      std::vector<ptr::Handle32<Counted>> handles;
+      for (int i = 0; i < 10'000; ++i) {
+        handles.push_back(ptr::make_handle32<Counted>(t * 10'000 + i));
+      }
+      for (int i = 0; i < 10'000; ++i) {
+        ptr::WeakHandle32<Counted> weak{handles[i]};
+        if (weak.lock()->value != t * 10'000 + i) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(!failed);
+}
@@ -0,0 +1,81 @@
+#include <catch.hpp>
+
+#include <ptr/interner.h>
+#include <ptr/weak.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("interner returns one instance per distinct value") {
+  ptr::Interner<std::string> interner;
+  ptr::Shared<const std::string> first = interner.intern("symbol");
+  std::string copy = "symbol";
+  ptr::Shared<const std::string> second = interner.intern(copy);
+  ptr::Shared<const std::string> other = interner.intern(std::string("other"));
+
+  REQUIRE(*first == "symbol");
+  REQUIRE(first.get() == second.get());
+  REQUIRE(other.get() != first.get());
+  REQUIRE(first.use_count() == 2);
+  REQUIRE(interner.size() == 2);
+
+  const ptr::InternerStats stats = interner.stats();
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 2);
+  REQUIRE(stats.live == 2);
+  REQUIRE(stats.dedup_ratio() == 1.5);
+  REQUIRE(stats.bytes_saved > sizeof(std::string));
+}
+
+TEST_CASE("interner forgets values that are no longer used") {
+  ptr::Interner<std::string> interner(4);
+  {
+    auto value = interner.intern("transient");
+    ptr::Weak<const std::string> observer{value};
+    REQUIRE(interner.size() == 1);
+  }
+  REQUIRE(interner.size() == 0);
+
+  auto value = interner.intern("transient");
+  REQUIRE(*value == "transient");
+  REQUIRE(interner.stats().misses == 2);
+}
+
+TEST_CASE("interned values may outlive the interner") {
+  ptr::Shared<const std::string> value;
+  {
+    ptr::Interner<std::string> interner(2);
+    value = interner.intern("survivor");
+  }
+  REQUIRE(*value == "survivor");
+}
+
+TEST_CASE("interner deduplicates concurrent interning") {
+  constexpr int threads = 8;
+  constexpr int distinct = 16;
+  ptr::Interner<int> interner(4);
+  std::vector<std::vector<ptr::Shared<const int>>> results(threads);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i]() {
+      for (int round = 0; round < 50; ++round) {
+        for (int value = 0; value < distinct; ++value) {
+          results[i].push_back(interner.intern(value));
+        }
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  // Every result is alive, so each value was created exactly once.
+  REQUIRE(interner.size() == distinct);
+  REQUIRE(interner.stats().misses == distinct);
+  for (const auto& thread_results : results) {
+    for (std::size_t j = 0; j < thread_results.size(); ++j) {
+      REQUIRE(thread_results[j].get() == results[0][j % distinct].get());
+    }
+  }
+}
@@ -0,0 +1,57 @@
+#include <catch.hpp>
+
+#include <ptr/large.h>
+#include <ptr/weak.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+using Image = std::array<std::uint8_t, 64 * 4096>;
+
+// Return the number of resident pages among the `pages` pages at `begin`.
+std::size_t resident_pages(const void *begin, std::size_t pages) {
+  std::vector<unsigned char> residency(pages);
+  REQUIRE(mincore(const_cast<void*>(begin), pages * sysconf(_SC_PAGESIZE),
+                  residency.data()) == 0);
+  std::size_t resident = 0;
+  for (unsigned char page : residency) {
+    resident += page & 1;
+  }
+  return resident;
+}
+
+} // namespace
+
+TEST_CASE("large objects give back their pages while weakly referenced") {
+  auto image = ptr::make_shared_large<Image>();
+  image->fill(7);
+  const void *storage = image.get();
+  REQUIRE(reinterpret_cast<std::uintptr_t>(storage) % ptr::large_object_alignment == 0);
+  const std::size_t pages = sizeof(Image) / sysconf(_SC_PAGESIZE);
+  REQUIRE(resident_pages(storage, pages) == pages);
+
+  ptr::Weak<Image> weak{image};
+  auto copy = image;
+  image.reset();
+  REQUIRE((*copy)[100] == 7);
+  copy.reset();
+  REQUIRE(weak.expired());
+#if defined(__linux__)
+  REQUIRE(resident_pages(storage, pages) == 0);
+#endif
+  weak.reset();
+}
+
+TEST_CASE("large objects without weak references are unmapped") {
+  auto values = ptr::make_shared_large<std::vector<int>>(1000, 1);
+  REQUIRE(values->size() == 1000);
+  ptr::Shared<const std::vector<int>> view = values;
+  values.reset();
+  REQUIRE(view->back() == 1);
+}
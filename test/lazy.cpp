@@ -0,0 +1,127 @@
+#include <catch.hpp>
+
+#include <ptr/lazy.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("lazy shared objects are created on first use") {
+  int created = 0;
+  ptr::LazyShared<std::string> lazy([&]() {
+    ++created;
+    return ptr::make_shared<std::string>("service");
+  });
+  REQUIRE(created == 0);
+
+  std::string& first = lazy.get();
+  REQUIRE(first == "service");
+  REQUIRE(lazy->size() == 7);
+  REQUIRE(&*lazy == &first);
+  ptr::Shared<std::string> owner = lazy.shared();
+  REQUIRE(owner.get() == &first);
+  REQUIRE(created == 1);
+}
+
+TEST_CASE("lazy shared objects are created once under contention") {
+  std::atomic<int> created = 0;
+  ptr::LazyShared<int> lazy([&]() {
+    ++created;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return ptr::make_shared<int>(42);
+  });
+
+  constexpr int threads = 8;
+  std::vector<int*> seen(threads);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i]() { seen[i] = &lazy.get(); });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  REQUIRE(created == 1);
+  for (int *object : seen) {
+    REQUIRE(object == seen[0]);
+  }
+  REQUIRE(*seen[0] == 42);
+}
+
+TEST_CASE("lazy shared factories that throw are retried") {
+  bool fail = true;
+  ptr::LazyShared<int> lazy([&]() {
+    if (fail) {
+      throw 1;
+    }
+    return ptr::make_shared<int>(7);
+  });
+  REQUIRE_THROWS(lazy.get());
+  fail = false;
+  REQUIRE(lazy.get() == 7);
+}
+
+TEST_CASE("lazy shared objects are retired on reload until reclaimed") {
+  int version = 0;
+  ptr::LazyShared<int> lazy([&]() { return ptr::make_shared<int>(++version); });
+
+  int& first = lazy.get();
+  ptr::Weak<int> first_observer{lazy.shared()};
+  REQUIRE(first == 1);
+
+  lazy.reload();
+  REQUIRE(lazy.get() == 2);
+  // The old object is still there for readers that borrowed it.
+  REQUIRE(first == 1);
+
+  lazy.reload(ptr::make_shared<int>(10));
+  REQUIRE(lazy.get() == 10);
+
+  lazy.reset();
+  REQUIRE(!first_observer.expired());
+  lazy.reclaim();
+  REQUIRE(first_observer.expired());
+
+  REQUIRE(lazy.get() == 3);
+}
+
+TEST_CASE("lazy shared objects keep retired versions until reclaimed") {
+  ptr::LazyShared<int> lazy([]() { return ptr::make_shared<int>(0); });
+  std::vector<ptr::Weak<int>> observers;
+  for (int i = 0; i < 100; ++i) {
+    lazy.reload();
+    observers.emplace_back(lazy.shared());
+  }
+  // Without a limit, every replaced object is still alive.
+  for (std::size_t i = 0; i + 1 < observers.size(); ++i) {
+    REQUIRE(!observers[i].expired());
+  }
+  lazy.reclaim();
+  for (std::size_t i = 0; i + 1 < observers.size(); ++i) {
+    REQUIRE(observers[i].expired());
+  }
+  REQUIRE(!observers.back().expired());
+}
+
+TEST_CASE("lazy shared objects keep at most the retired limit") {
+  constexpr std::size_t limit = 4;
+  ptr::LazyShared<int> lazy([]() { return ptr::make_shared<int>(0); }, limit);
+  std::vector<ptr::Weak<int>> observers;
+  for (int i = 0; i < 1000; ++i) {
+    lazy.reload();
+    observers.emplace_back(lazy.shared());
+  }
+  lazy.reset();
+
+  std::size_t alive = 0;
+  for (const ptr::Weak<int>& observer : observers) {
+    alive += !observer.expired();
+  }
+  REQUIRE(alive == limit);
+  for (std::size_t i = observers.size() - limit; i < observers.size(); ++i) {
+    REQUIRE(!observers[i].expired());
+  }
+}
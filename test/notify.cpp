@@ -0,0 +1,64 @@
+#include <catch.hpp>
+
+#include <ptr/notify.h>
+#include <ptr/weak.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE("expiry callbacks run once, in registration order") {
+  std::vector<int> calls;
+  bool alive_during_callback = false;
+  {
+    auto object = ptr::make_shared_notifying<std::string>("hi");
+    ptr::Weak<std::string> observer{object};
+    REQUIRE(ptr::on_expire(object, [&]() { calls.push_back(1); }));
+    REQUIRE(ptr::on_expire(object, [&, observer]() {
+      calls.push_back(2);
+      alive_during_callback = observer.lock().get() != nullptr;
+    }));
+    auto copy = object;
+    object.reset();
+    REQUIRE(calls.empty());
+  }
+  REQUIRE(calls == std::vector<int>{1, 2});
+  REQUIRE(!alive_during_callback);
+}
+
+TEST_CASE("expiry hooks require a notifying control block") {
+  auto plain = ptr::make_shared<int>(1);
+  REQUIRE(!ptr::on_expire(plain, []() {}));
+  REQUIRE(!ptr::on_expire(ptr::Shared<int>{}, []() {}));
+
+  ptr::ExpiryQueue<int> queue;
+  REQUIRE(!queue.watch(plain, 1));
+}
+
+TEST_CASE("expiry queue delivers keys of expired objects") {
+  ptr::ExpiryQueue<std::string> queue;
+  auto first = ptr::make_shared_notifying<int>(1);
+  auto second = ptr::make_shared_notifying<int>(2);
+  ptr::Shared<const int> third = ptr::make_shared_notifying<int>(3);
+  REQUIRE(queue.watch(first, "first"));
+  REQUIRE(queue.watch(second, "second"));
+  REQUIRE(queue.watch(third, "third"));
+  REQUIRE(queue.empty());
+
+  first.reset();
+  third.reset();
+  std::set<std::string> drained;
+  REQUIRE(queue.drain([&](const std::string& key) { drained.insert(key); }) == 2);
+  REQUIRE(drained == std::set<std::string>{"first", "third"});
+  REQUIRE(queue.empty());
+  REQUIRE(queue.drain([](const std::string&) {}) == 0);
+}
+
+TEST_CASE("watched objects may outlive their expiry queue") {
+  auto object = ptr::make_shared_notifying<int>(1);
+  {
+    ptr::ExpiryQueue<int> queue;
+    REQUIRE(queue.watch(object, 1));
+  }
+  object.reset();
+}
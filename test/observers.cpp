@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <ptr/owner.h>
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <map>
+#include <set>
+#include <unordered_set>
+
+TEST_CASE("use_count, unique, and expired observe the ref counts") {
+  ptr::Shared<int> empty;
+  REQUIRE(empty.use_count() == 0);
+  REQUIRE(!empty.unique());
+  REQUIRE(ptr::Weak<int>{}.expired());
+  REQUIRE(ptr::Weak<int>{}.use_count() == 0);
+
+  auto first = ptr::make_shared<int>(1);
+  REQUIRE(first.use_count() == 1);
+  REQUIRE(first.unique());
+
+  ptr::Weak<int> observer{first};
+  REQUIRE(!observer.expired());
+  REQUIRE(observer.use_count() == 1);
+
+  ptr::Shared<const int> second = first;
+  REQUIRE(first.use_count() == 2);
+  REQUIRE(!first.unique());
+  REQUIRE(observer.use_count() == 2);
+
+  first.reset();
+  second.reset();
+  REQUIRE(observer.expired());
+  REQUIRE(observer.use_count() == 0);
+}
+
+TEST_CASE("owner comparisons see through aliasing and expiry") {
+  struct Pair {
+    int first;
+    int second;
+  };
+  auto pair = ptr::make_shared<Pair>(Pair{1, 2});
+  ptr::Shared<int> first(pair, &pair->first);
+  ptr::Shared<int> second(pair, &pair->second);
+  auto other = ptr::make_shared<int>(3);
+
+  REQUIRE(first.owner_equal(second));
+  REQUIRE(first.owner_hash() == second.owner_hash());
+  REQUIRE(!first.owner_equal(other));
+  REQUIRE(first.owner_before(other) != other.owner_before(first));
+  REQUIRE(!first.owner_before(second));
+  REQUIRE(!second.owner_before(first));
+
+  std::set<ptr::Weak<int>, ptr::OwnerLess> ordered;
+  std::unordered_set<ptr::Weak<int>, ptr::OwnerHash, ptr::OwnerEqual> hashed;
+  ordered.insert(ptr::Weak<int>{first});
+  hashed.insert(ptr::Weak<int>{first});
+  REQUIRE(!ordered.insert(ptr::Weak<int>{second}).second);
+  REQUIRE(!hashed.insert(ptr::Weak<int>{second}).second);
+  REQUIRE(ordered.insert(ptr::Weak<int>{other}).second);
+  REQUIRE(hashed.insert(ptr::Weak<int>{other}).second);
+
+  // Keys remain usable after their objects die, and transparent lookup works
+  // with `ptr::Shared`.
+  other.reset();
+  REQUIRE(ordered.size() == 2);
+  REQUIRE(ordered.find(pair) != ordered.end());
+}
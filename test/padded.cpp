@@ -0,0 +1,32 @@
+#include <catch.hpp>
+
+#include <ptr/padded.h>
+#include <ptr/weak.h>
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+template <typename Object>
+std::uintptr_t address(const Object *object) {
+  return reinterpret_cast<std::uintptr_t>(object);
+}
+
+} // namespace
+
+TEST_CASE("padded objects start on their own cache line") {
+  auto counter = ptr::make_shared_padded<std::uint64_t>(7);
+  REQUIRE(*counter == 7);
+  REQUIRE(address(counter.get()) % ptr::cache_line_size == 0);
+
+  ptr::ControlBlock *control_block = ptr::HandleAccess::control_block(counter);
+  REQUIRE(address(counter.get()) - address(control_block) == ptr::cache_line_size);
+  static_assert(sizeof(ptr::PaddedControlBlock<std::uint64_t>) == 2 * ptr::cache_line_size);
+
+  ptr::Weak<std::uint64_t> weak{counter};
+  auto name = ptr::make_shared_padded<std::string>(100, 'x');
+  REQUIRE(name->size() == 100);
+  counter.reset();
+  REQUIRE(weak.expired());
+}
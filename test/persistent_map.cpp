@@ -0,0 +1,179 @@
+#include <catch.hpp>
+
+#include <ptr/persistent_map.h>
+
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// `Colliding` sends many keys to the same hash, to exercise collision nodes.
+struct Colliding {
+  std::size_t operator()(int key) const {
+    return std::size_t(key % 4) * 0x9e3779b97f4a7c15ull;
+  }
+};
+
+template <typename Map>
+std::map<int, int> contents(const Map& map) {
+  std::map<int, int> result;
+  map.for_each([&](int key, int value) { result.emplace(key, value); });
+  return result;
+}
+
+} // namespace
+
+TEST_CASE("persistent map versions are independent") {
+  ptr::PersistentMap<int, int> empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.find(1) == nullptr);
+
+  ptr::PersistentMap<int, int> map;
+  std::map<int, int> expected;
+  for (int i = 0; i < 5000; ++i) {
+    map = map.set(i * 7, i);
+    expected[i * 7] = i;
+  }
+  const auto before = map;
+
+  auto after = map.set(0, -1).erase(7).erase(123'456).set(35'000, 1);
+  REQUIRE(contents(before) == expected);
+  REQUIRE(before.size() == 5000);
+  REQUIRE(after.size() == 5000);
+  REQUIRE(*after.find(0) == -1);
+  REQUIRE(!after.contains(7));
+  REQUIRE(*after.find(35'000) == 1);
+  REQUIRE(*before.find(0) == 0);
+  REQUIRE(before.contains(7));
+
+  for (int i = 0; i < 5000; ++i) {
+    after = after.erase(i * 7);
+  }
+  REQUIRE(after.size() == 1);
+  REQUIRE(contents(after) == std::map<int, int>{{35'000, 1}});
+  REQUIRE(after.erase(35'000).empty());
+}
+
+TEST_CASE("persistent map handles full hash collisions") {
+  ptr::PersistentMap<int, int, Colliding> map;
+  for (int i = 0; i < 40; ++i) {
+    map = map.set(i, i * i);
+  }
+  REQUIRE(map.size() == 40);
+  for (int i = 0; i < 40; ++i) {
+    REQUIRE(*map.find(i) == i * i);
+  }
+  for (int i = 0; i < 40; i += 2) {
+    map = map.erase(i);
+  }
+  REQUIRE(map.size() == 20);
+  for (int i = 0; i < 40; ++i) {
+    REQUIRE(map.contains(i) == (i % 2 == 1));
+  }
+}
+
+TEST_CASE("persistent map transients modify in place safely") {
+  ptr::PersistentMap<std::string, int> original;
+  for (int i = 0; i < 300; ++i) {
+    original = original.set(std::to_string(i), i);
+  }
+
+  auto transient = original.transient();
+  for (int i = 0; i < 300; i += 3) {
+    transient.erase(std::to_string(i));
+  }
+  auto snapshot = transient.persistent();
+  for (int i = 300; i < 1000; ++i) {
+    transient.set(std::to_string(i), i);
+  }
+  transient.set("1", -1);
+  auto result = transient.persistent();
+
+  REQUIRE(original.size() == 300);
+  REQUIRE(snapshot.size() == 200);
+  REQUIRE(result.size() == 900);
+  REQUIRE(*original.find("0") == 0);
+  REQUIRE(!snapshot.contains("0"));
+  REQUIRE(*snapshot.find("1") == 1);
+  REQUIRE(*result.find("1") == -1);
+  REQUIRE(*result.find("999") == 999);
+}
+
+namespace {
+
+// `Brittle` is a value whose copies throw once `copies_left` reaches zero.
+struct Brittle {
+  static inline int copies_left = -1;
+
+  std::string text;
+
+  explicit Brittle(std::string text) : text(std::move(text)) {}
+  Brittle(const Brittle& other) : text(other.text) {
+    if (copies_left == 0) {
+      throw std::runtime_error("copy failed");
+    }
+    --copies_left;
+  }
+  // Not `noexcept`, so that growing a vector of `Brittle` copies them.
+  Brittle(Brittle&& other) : text(std::move(other.text)) {}
+  Brittle& operator=(const Brittle&) = default;
+  Brittle& operator=(Brittle&&) = default;
+};
+
+} // namespace
+
+TEST_CASE("persistent map transients survive a failed split") {
+  // Keys 1 and 5 share a hash fragment at the root, so inserting 5 moves 1
+  // down into a new child.
+  ptr::PersistentMap<int, Brittle, Colliding> map;
+  auto transient = map.transient();
+  transient.set(1, Brittle("one"));
+
+  Brittle::copies_left = 0;
+  REQUIRE_THROWS_AS(transient.set(5, Brittle("five")), std::runtime_error);
+  Brittle::copies_left = -1;
+  REQUIRE(transient.size() == 1);
+  REQUIRE(transient.find(1)->text == "one");
+
+  transient.set(5, Brittle("five"));
+  REQUIRE(transient.find(1)->text == "one");
+  REQUIRE(transient.find(5)->text == "five");
+}
+
+namespace {
+
+// `Modular` hashes and compares keys modulo a divisor chosen at run time, so
+// that it has state and no default constructor.
+struct Modular {
+  int divisor;
+
+  explicit Modular(int divisor) : divisor(divisor) {}
+
+  std::size_t operator()(int key) const {
+    return std::hash<int>{}(key % divisor);
+  }
+
+  bool operator()(int left, int right) const {
+    return left % divisor == right % divisor;
+  }
+};
+
+} // namespace
+
+TEST_CASE("persistent maps keep their hash and equality functors") {
+  ptr::PersistentMap<int, int, Modular, Modular> map(Modular(10), Modular(10));
+  for (int i = 0; i < 100; ++i) {
+    map = map.set(i, i);
+  }
+  REQUIRE(map.size() == 10);
+  REQUIRE(*map.find(3) == 93);
+  REQUIRE(*map.find(1003) == 93);
+
+  auto transient = map.transient();
+  transient.erase(13);
+  REQUIRE(transient.size() == 9);
+  REQUIRE(!transient.find(3));
+  REQUIRE(map.erase(23).size() == 9);
+}
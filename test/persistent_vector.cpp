@@ -0,0 +1,111 @@
+#include <catch.hpp>
+
+#include <ptr/persistent_vector.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("persistent vector versions are independent") {
+  ptr::PersistentVector<int> empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.begin() == empty.end());
+
+  // Cross several trie depths: the tail, one level, two levels, and three.
+  constexpr std::size_t count = 40'000;
+  std::vector<ptr::PersistentVector<int>> versions{empty};
+  for (std::size_t i = 0; i < count; ++i) {
+    versions.push_back(versions.back().push_back(int(i)));
+  }
+
+  for (std::size_t size : {std::size_t(0), std::size_t(1), std::size_t(32),
+                           std::size_t(33), std::size_t(1024),
+                           std::size_t(1057), count}) {
+    const auto& version = versions[size];
+    REQUIRE(version.size() == size);
+    std::size_t expected = 0;
+    for (int value : version) {
+      REQUIRE(value == int(expected++));
+    }
+    REQUIRE(expected == size);
+  }
+
+  auto changed = versions[count].set(5, -5).set(count - 1, -1).set(2000, -2000);
+  REQUIRE(changed[5] == -5);
+  REQUIRE(changed[count - 1] == -1);
+  REQUIRE(changed[2000] == -2000);
+  REQUIRE(versions[count][5] == 5);
+  REQUIRE(versions[count][count - 1] == int(count - 1));
+  REQUIRE(versions[count][2000] == 2000);
+  REQUIRE_THROWS_AS(changed.at(count), std::out_of_range);
+}
+
+TEST_CASE("transients modify in place without affecting other versions") {
+  ptr::PersistentVector<std::string> original;
+  for (int i = 0; i < 100; ++i) {
+    original = original.push_back(std::to_string(i));
+  }
+
+  auto transient = original.transient();
+  for (int i = 0; i < 100; ++i) {
+    transient.set(i, "x" + std::to_string(i));
+  }
+  auto snapshot = transient.persistent();
+  for (int i = 100; i < 2000; ++i) {
+    transient.emplace_back(std::to_string(i));
+  }
+  transient.set(0, "changed after snapshot");
+  auto result = transient.persistent();
+
+  REQUIRE(original.size() == 100);
+  REQUIRE(snapshot.size() == 100);
+  REQUIRE(result.size() == 2000);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(original[i] == std::to_string(i));
+  }
+  REQUIRE(snapshot[0] == "x0");
+  REQUIRE(snapshot[99] == "x99");
+  REQUIRE(result[0] == "changed after snapshot");
+  REQUIRE(result[1] == "x1");
+  REQUIRE(result[1999] == "1999");
+}
+
+namespace {
+
+// `Fragile` counts its instances, and its copy constructor throws once
+// `copies_left` reaches zero.
+struct Fragile {
+  static inline int alive = 0;
+  static inline int copies_left = -1;
+
+  Fragile() { ++alive; }
+  Fragile(const Fragile&) {
+    if (copies_left == 0) {
+      throw std::runtime_error("copy failed");
+    }
+    --copies_left;
+    ++alive;
+  }
+  ~Fragile() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("persistent vector leaves clean up after a failed copy") {
+  {
+    ptr::PersistentVector<Fragile> vector;
+    for (int i = 0; i < 10; ++i) {
+      vector = vector.push_back(Fragile());
+    }
+    REQUIRE(Fragile::alive == 10);
+
+    // Copying the tail for the next version fails partway through.
+    Fragile::copies_left = 4;
+    REQUIRE_THROWS_AS(vector.push_back(Fragile()), std::runtime_error);
+    Fragile::copies_left = -1;
+    REQUIRE(Fragile::alive == 10);
+    REQUIRE(vector.size() == 10);
+  }
+  REQUIRE(Fragile::alive == 0);
+}
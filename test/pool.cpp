@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <ptr/pool.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Order {
+  static inline std::atomic<int> alive{0};
+
+  int id;
+
+  explicit Order(int id)
+  : id(id) {
+    if (id < 0) {
+      throw std::invalid_argument("negative order id");
+    }
+    ++alive;
+  }
+
+  ~Order() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("pooled blocks are reused once released") {
+  ptr::Pool<Order> pool(4);
+  std::vector<ptr::Shared<Order>> orders;
+  for (int i = 0; i < 4; ++i) {
+    orders.push_back(pool.make_shared(i));
+  }
+  REQUIRE(pool.slab_count() == 1);
+  REQUIRE(orders[3]->id == 3);
+
+  const Order *first = orders[0].get();
+  ptr::Weak<Order> weak{orders[0]};
+  orders[0].reset();
+  REQUIRE(Order::alive == 3);
+  // The weak reference still holds the block.
+  orders.push_back(pool.make_shared(4));
+  REQUIRE(pool.slab_count() == 2);
+
+  // The rest of the second slab is used first, and then the released block.
+  weak = ptr::Weak<Order>{};
+  for (int i = 0; i < 4; ++i) {
+    orders.push_back(pool.make_shared(5 + i));
+  }
+  bool reused = false;
+  for (const auto& order : orders) {
+    reused = reused || order.get() == first;
+  }
+  REQUIRE(reused);
+  REQUIRE(pool.slab_count() == 2);
+}
+
+TEST_CASE("pooled objects outlive their pool") {
+  ptr::Shared<Order> survivor;
+  {
+    ptr::Pool<Order> pool;
+    survivor = pool.make_shared(1);
+    REQUIRE_THROWS_AS(pool.make_shared(-1), std::invalid_argument);
+  }
+  REQUIRE(survivor->id == 1);
+  REQUIRE(Order::alive == 1);
+  survivor.reset();
+  REQUIRE(Order::alive == 0);
+}
+
+TEST_CASE("pooled objects can be released on other threads") {
+  ptr::Pool<Order> pool(64);
+  for (int round = 0; round < 20; ++round) {
+    std::vector<ptr::Shared<Order>> orders;
+    for (int i = 0; i < 500; ++i) {
+      orders.push_back(pool.make_shared(i));
+    }
+    std::thread releaser([orders = std::move(orders)]() mutable { orders.clear(); });
+    std::vector<ptr::Shared<Order>> more;
+    for (int i = 0; i < 500; ++i) {
+      more.push_back(pool.make_shared(i));
+    }
+    releaser.join();
+  }
+  REQUIRE(Order::alive == 0);
+  REQUIRE(pool.slab_count() <= 1000 / 64 + 2);
+}
@@ -0,0 +1,71 @@
+#include <catch.hpp>
+
+#include <ptr/publisher.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("publisher readers see new versions") {
+  ptr::Publisher<std::string> publisher(ptr::make_shared<std::string>("v0"));
+  ptr::Publisher<std::string>::Reader reader(publisher);
+  REQUIRE(publisher.version() == 0);
+  REQUIRE(*reader == "v0");
+  REQUIRE(reader->size() == 2);
+
+  auto v0 = publisher.snapshot();
+  REQUIRE(reader.get().get() == v0.get());
+
+  publisher.publish(ptr::make_shared<std::string>("v1"));
+  REQUIRE(publisher.version() == 1);
+  REQUIRE(*publisher.snapshot() == "v1");
+  REQUIRE(*reader == "v1");
+}
+
+TEST_CASE("publisher readers keep their last version until they read again") {
+  ptr::Publisher<int> publisher(ptr::make_shared<int>(1));
+  ptr::Publisher<int>::Reader reader(publisher);
+  ptr::Weak<int> first{publisher.snapshot()};
+
+  publisher.publish(ptr::make_shared<int>(2));
+  REQUIRE(!first.expired());
+  REQUIRE(*reader == 2);
+  REQUIRE(first.expired());
+}
+
+TEST_CASE("publisher readers start out empty if nothing is published") {
+  ptr::Publisher<int> publisher;
+  ptr::Publisher<int>::Reader reader(publisher);
+  REQUIRE(!reader.get().get());
+  publisher.publish(ptr::make_shared<int>(3));
+  REQUIRE(*reader == 3);
+}
+
+TEST_CASE("publisher readers on other threads see versions in order") {
+  ptr::Publisher<int> publisher(ptr::make_shared<int>(0));
+  constexpr int versions = 200;
+  std::atomic<bool> out_of_order = false;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      thread_local ptr::Publisher<int>::Reader reader(publisher);
+      int last = 0;
+      while (last != versions) {
+        const int seen = *reader;
+        if (seen < last) {
+          out_of_order = true;
+        }
+        last = seen;
+      }
+    });
+  }
+  for (int i = 1; i <= versions; ++i) {
+    publisher.publish(ptr::make_shared<int>(i));
+  }
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  REQUIRE(!out_of_order);
+}
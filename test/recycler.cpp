@@ -0,0 +1,113 @@
+#include <catch.hpp>
+
+#include <ptr/recycler.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Buffer {
+  static inline std::atomic<int> constructed{0};
+  static inline std::atomic<int> alive{0};
+
+  std::vector<char> bytes;
+
+  Buffer() {
+    bytes.reserve(4096);
+    ++constructed;
+    ++alive;
+  }
+
+  ~Buffer() { --alive; }
+};
+
+struct Clear {
+  void operator()(Buffer& buffer) const {
+    buffer.bytes.clear();
+  }
+};
+
+} // namespace
+
+TEST_CASE("recycled objects are reset and reused") {
+  Buffer::constructed = 0;
+  {
+    ptr::Recycler<Buffer, Clear> recycler(2);
+    auto first = recycler.acquire();
+    first->bytes.assign(100, 'x');
+    const Buffer *address = first.get();
+
+    ptr::Weak<Buffer> weak{first};
+    first.reset();
+    REQUIRE(weak.expired());
+    REQUIRE(recycler.size() == 0);
+    weak.reset();
+    REQUIRE(recycler.size() == 1);
+
+    auto second = recycler.acquire();
+    REQUIRE(second.get() == address);
+    REQUIRE(second->bytes.empty());
+    REQUIRE(second->bytes.capacity() >= 4096);
+    REQUIRE(second.use_count() == 1);
+    REQUIRE(recycler.hits() == 1);
+    REQUIRE(recycler.misses() == 1);
+    REQUIRE(Buffer::constructed == 1);
+  }
+  REQUIRE(Buffer::alive == 0);
+}
+
+TEST_CASE("recyclers keep at most their capacity") {
+  ptr::Recycler<Buffer, Clear> recycler(2);
+  {
+    std::vector<ptr::Shared<Buffer>> buffers;
+    for (int i = 0; i < 5; ++i) {
+      buffers.push_back(recycler.acquire());
+    }
+    REQUIRE(Buffer::alive == 5);
+  }
+  REQUIRE(recycler.size() == 2);
+  REQUIRE(Buffer::alive == 2);
+}
+
+TEST_CASE("recycled objects may outlive the recycler and cross threads") {
+  ptr::Shared<Buffer> survivor;
+  {
+    ptr::Recycler<Buffer, Clear> recycler(64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&recycler]() {
+        for (int i = 0; i < 1000; ++i) {
+          auto buffer = recycler.acquire();
+          buffer->bytes.push_back('x');
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(recycler.hits() + recycler.misses() == 4000);
+    REQUIRE(recycler.misses() <= 64 + 4);
+    survivor = recycler.acquire();
+  }
+  REQUIRE(Buffer::alive == 1);
+  survivor.reset();
+  REQUIRE(Buffer::alive == 0);
+}
+
+TEST_CASE("recycled objects ignore construction arguments") {
+  ptr::Recycler<std::string> recycler(1);
+  {
+    auto first = recycler.acquire_or_construct(3, 'a');
+    REQUIRE(*first == "aaa");
+  }
+  auto second = recycler.acquire_or_construct(5, 'b');
+  REQUIRE(*second == "aaa");
+  auto third = recycler.acquire_or_construct(5, 'b');
+  REQUIRE(*third == "bbbbb");
+  REQUIRE(recycler.hits() == 1);
+  REQUIRE(recycler.misses() == 2);
+}
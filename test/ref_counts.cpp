@@ -0,0 +1,62 @@
+#include <catch.hpp>
+
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Counted {
+  static inline std::atomic<int> alive = 0;
+
+  Counted() { ++alive; }
+  ~Counted() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("a dead object stays dead") {
+  auto object = ptr::make_shared<int>(1);
+  ptr::Weak<int> observer{object};
+  object.reset();
+  REQUIRE(observer.expired());
+  REQUIRE(observer.lock().get() == nullptr);
+  REQUIRE(observer.lock().get() == nullptr);
+  REQUIRE(observer.use_count() == 0);
+}
+
+TEST_CASE("lock races with the release of the last strong reference") {
+  constexpr int rounds = 500;
+  constexpr int lockers = 3;
+  for (int round = 0; round < rounds; ++round) {
+    auto object = ptr::make_shared<Counted>();
+    ptr::Weak<Counted> observer{object};
+    std::atomic<bool> go = false;
+    std::atomic<bool> locked_dead_object = false;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < lockers; ++i) {
+      threads.emplace_back([&]() {
+        while (!go) {
+        }
+        for (int attempt = 0; attempt < 10; ++attempt) {
+          ptr::Shared<Counted> locked = observer.lock();
+          if (locked.get() && Counted::alive < 1) {
+            locked_dead_object = true;
+          }
+        }
+        observer.expired();
+      });
+    }
+    go = true;
+    object.reset();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(!locked_dead_object);
+    REQUIRE(observer.expired());
+    REQUIRE(Counted::alive == 0);
+  }
+}
@@ -0,0 +1,102 @@
+#include <catch.hpp>
+
+#include <ptr/shm.h>
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct Message {
+  std::uint32_t id;
+  char text[60];
+};
+
+} // namespace
+
+TEST_CASE("shm objects are shared between mappings at different addresses") {
+  auto producer = ptr::shm::Region::create(1 << 16);
+  auto consumer = ptr::shm::Region::open(dup(producer.fd()));
+
+  auto message = ptr::shm::make_shared<Message>(producer, Message{7, "hello"});
+  ptr::shm::Shared<Message> copy = message;
+  REQUIRE(message.use_count() == 2);
+
+  const ptr::shm::Offset offset = copy.release();
+  REQUIRE(!copy);
+  auto received = ptr::shm::Shared<const Message>::adopt(consumer, offset);
+  REQUIRE(received.get() != static_cast<const void*>(message.get()));
+  REQUIRE(received->id == 7);
+  REQUIRE(std::strcmp(received->text, "hello") == 0);
+
+  message->id = 8;
+  REQUIRE(received->id == 8);
+  message.reset();
+  REQUIRE(received.use_count() == 1);
+}
+
+TEST_CASE("shm regions reuse the memory of released objects") {
+  auto region = ptr::shm::Region::create(4096);
+  for (int i = 0; i < 1000; ++i) {
+    auto buffer = ptr::shm::make_shared_array<char>(region, 1000);
+    REQUIRE(buffer.size() == 1000);
+    REQUIRE(buffer[999] == 0);
+  }
+  auto buffer = ptr::shm::make_shared_array<char>(region, 3000);
+  REQUIRE_THROWS_AS(ptr::shm::make_shared_array<char>(region, 3000), std::bad_alloc);
+}
+
+TEST_CASE("shm regions merge freed neighbours") {
+  auto region = ptr::shm::Region::create(4096);
+  for (int round = 0; round < 100; ++round) {
+    std::vector<ptr::shm::Shared<char>> buffers;
+    for (int i = 0; i < 8; ++i) {
+      buffers.push_back(ptr::shm::make_shared_array<char>(region, 400));
+    }
+    // Free every other buffer, then the rest from the middle out, so that
+    // chunks are freed next to free chunks on either side.
+    for (int i : {0, 2, 4, 6, 3, 5, 1, 7}) {
+      buffers[i].reset();
+    }
+    // Only one chunk's worth of memory is left if the frees were merged.
+    auto large = ptr::shm::make_shared_array<char>(region, 3500);
+    REQUIRE(large.size() == 3500);
+  }
+}
+
+TEST_CASE("shm references can be handed to another process") {
+  auto region = ptr::shm::Region::create(1 << 20);
+  auto buffer = ptr::shm::make_shared_array<std::uint32_t>(region, 100'000);
+  for (std::uint32_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = i;
+  }
+  ptr::shm::Shared<std::uint32_t> handed = buffer;
+  const ptr::shm::Offset offset = handed.release();
+  REQUIRE(buffer.use_count() == 2);
+
+  const pid_t child = fork();
+  REQUIRE(child != -1);
+  if (child == 0) {
+    // Map the region anew, as an unrelated process would.
+    int status = 1;
+    {
+      auto mapping = ptr::shm::Region::open(dup(region.fd()));
+      auto received = ptr::shm::Shared<const std::uint32_t>::adopt(mapping, offset);
+      if (received.size() == 100'000 && received[12'345] == 12'345) {
+        status = 0;
+      }
+    }
+    _exit(status);
+  }
+
+  int status = 0;
+  REQUIRE(waitpid(child, &status, 0) == child);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+  REQUIRE(buffer.use_count() == 1);
+}
@@ -0,0 +1,142 @@
+#include <catch.hpp>
+
+#include <ptr/notify.h>
+#include <ptr/owner.h>
+#include <ptr/shared.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <map>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Counted {
+  static inline std::atomic<int> alive{0};
+
+  Counted() { ++alive; }
+  virtual ~Counted() { --alive; }
+};
+
+struct Other {
+  int value = 3;
+  virtual ~Other() = default;
+};
+
+struct Both : Counted, Other {};
+
+} // namespace
+
+TEST_CASE("a handle from a raw pointer owns it alone until shared") {
+  {
+    ptr::Shared<Counted> owner(new Counted);
+    REQUIRE(owner.use_count() == 1);
+    REQUIRE(owner.unique());
+    ptr::Shared<Counted> moved = std::move(owner);
+    ptr::Shared<const Counted> converted = std::move(moved);
+    REQUIRE(converted.unique());
+  }
+  REQUIRE(Counted::alive == 0);
+
+  ptr::Shared<Counted> owner(new Counted);
+  ptr::Shared<Counted> copy = owner;
+  REQUIRE(owner.use_count() == 2);
+  REQUIRE(copy.owner_equal(owner));
+  ptr::Weak<Counted> weak{owner};
+  owner.reset();
+  copy.reset();
+  REQUIRE(weak.expired());
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("a sole owner converted to another address gets a control block") {
+  ptr::Shared<Both> both(new Both);
+  ptr::Shared<Other> other = std::move(both);
+  REQUIRE(other->value == 3);
+  REQUIRE(other.use_count() == 1);
+  other.reset();
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("sole owners keep stateless deleters but not stateful ones") {
+  static int deleted = 0;
+  struct Stateless {
+    void operator()(int *value) const {
+      ++deleted;
+      delete value;
+    }
+  };
+  { ptr::Shared<int> value(new int(1), Stateless{}); }
+  REQUIRE(deleted == 1);
+
+  int calls = 0;
+  {
+    ptr::Shared<int> value(new int(2), [&calls](int *value) {
+      ++calls;
+      delete value;
+    });
+    ptr::Shared<int> copy = value;
+  }
+  REQUIRE(calls == 1);
+}
+
+TEST_CASE("a sole owner may be shared by several threads at once") {
+  for (int round = 0; round < 200; ++round) {
+    const ptr::Shared<Counted> owner(new Counted);
+    std::vector<ptr::Shared<Counted>> copies(4);
+    std::vector<ptr::Weak<Counted>> weaks(4);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&, i]() {
+        if (i % 2) {
+          copies[i] = owner;
+        } else {
+          weaks[i] = ptr::Weak<Counted>{owner};
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(owner.use_count() == 3);
+    REQUIRE(copies[1].owner_equal(weaks[0]));
+    REQUIRE(copies[3].owner_equal(owner));
+  }
+  REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("watching a sole owner does not give it a control block") {
+  ptr::Shared<Counted> owner(new Counted);
+  REQUIRE(!ptr::on_expire(owner, []() {}));
+  REQUIRE(!ptr::HandleAccess::existing_control_block(owner));
+}
+
+TEST_CASE("a sole owner's identity outlives its object") {
+  // Destroy the objects in place, so that the second one reuses the address
+  // of the first, as a fresh allocation might.
+  struct DestroyInPlace {
+    void operator()(Counted *object) const {
+      object->~Counted();
+    }
+  };
+  alignas(Counted) unsigned char storage[sizeof(Counted)];
+
+  ptr::Shared<Counted> first(new (storage) Counted, DestroyInPlace());
+  const std::size_t hash = first.owner_hash();
+  ptr::Weak<Counted> expired{first};
+  REQUIRE(expired.owner_hash() == hash);
+  first.reset();
+  REQUIRE(expired.expired());
+
+  ptr::Shared<Counted> second(new (storage) Counted, DestroyInPlace());
+  REQUIRE(second.get() == static_cast<void*>(storage));
+  REQUIRE(!expired.owner_equal(second));
+  REQUIRE(!second.owner_equal(expired));
+  REQUIRE(expired.owner_before(second) != second.owner_before(expired));
+
+  std::map<ptr::Weak<Counted>, int, ptr::OwnerLess> keyed;
+  keyed.emplace(expired, 1);
+  REQUIRE(keyed.find(second) == keyed.end());
+}
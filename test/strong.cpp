@@ -0,0 +1,94 @@
+#include <catch.hpp>
+
+#include <ptr/strong.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct Base {
+  static inline std::atomic<int> alive = 0;
+
+  Base() { ++alive; }
+  // Not virtual: the block remembers how to destroy a `Derived`.
+  ~Base() { --alive; }
+};
+
+struct Derived : Base {
+  std::string name = "derived";
+};
+
+} // namespace
+
+static_assert(!std::is_constructible_v<ptr::Weak<Base>, const ptr::StrongShared<Base>&>);
+static_assert(!std::is_constructible_v<ptr::Shared<Base>, const ptr::StrongShared<Base>&>);
+static_assert(!std::is_constructible_v<ptr::StrongShared<Derived>,
+                                       const ptr::StrongShared<Base>&>);
+
+TEST_CASE("strong-only objects are destroyed with their last reference") {
+  {
+    auto derived = ptr::make_shared_strong_only<Derived>();
+    REQUIRE(derived->name == "derived");
+    REQUIRE(derived.use_count() == 1);
+    REQUIRE(derived.unique());
+
+    ptr::StrongShared<Base> base = derived;
+    REQUIRE(base.get() == derived.get());
+    REQUIRE(derived.use_count() == 2);
+    REQUIRE(!derived.unique());
+
+    derived.reset();
+    REQUIRE(!derived);
+    REQUIRE(Base::alive == 1);
+    REQUIRE(base.use_count() == 1);
+
+    ptr::StrongShared<const Base> moved = std::move(base);
+    REQUIRE(!base);
+    REQUIRE(moved.use_count() == 1);
+  }
+  REQUIRE(Base::alive == 0);
+
+  ptr::StrongShared<Base> empty = nullptr;
+  REQUIRE(empty.use_count() == 0);
+  REQUIRE(!empty.unique());
+}
+
+TEST_CASE("strong-only handles can be assigned and swapped") {
+  auto first = ptr::make_shared_strong_only<std::string>("first");
+  auto second = ptr::make_shared_strong_only<std::string>("second");
+  swap(first, second);
+  REQUIRE(*first == "second");
+  REQUIRE(*second == "first");
+
+  first = second;
+  REQUIRE(*first == "first");
+  REQUIRE(first.use_count() == 2);
+  first = first;
+  REQUIRE(first.use_count() == 2);
+  second = ptr::StrongShared<std::string>();
+  REQUIRE(first.use_count() == 1);
+}
+
+TEST_CASE("strong-only objects are released once across threads") {
+  constexpr int threads = 4;
+  constexpr int copies = 1000;
+  {
+    auto shared = ptr::make_shared_strong_only<Derived>();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+      workers.emplace_back([copy = shared]() {
+        std::vector<ptr::StrongShared<Derived>> held(copies, copy);
+      });
+    }
+    shared.reset();
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+  REQUIRE(Base::alive == 0);
+}
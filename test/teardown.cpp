@@ -0,0 +1,88 @@
+#include <catch.hpp>
+
+#include <ptr/teardown.h>
+#include <ptr/weak.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace {
+
+struct Node {
+  static inline std::atomic<int> alive{0};
+  static inline std::mutex mutex;
+  static inline std::set<std::thread::id> destroyers;
+
+  ptr::Shared<Node> left;
+  ptr::Shared<Node> right;
+
+  Node() { ++alive; }
+
+  ~Node() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      destroyers.insert(std::this_thread::get_id());
+    }
+    --alive;
+  }
+};
+
+ptr::Shared<Node> tree(int depth) {
+  auto node = ptr::make_shared_teardown<Node>();
+  if (depth > 0) {
+    node->left = tree(depth - 1);
+    node->right = tree(depth - 1);
+  }
+  return node;
+}
+
+} // namespace
+
+TEST_CASE("teardown pools destroy graphs on their own threads") {
+  Node::destroyers.clear();
+  ptr::TeardownPool pool(3);
+  auto root = tree(12);
+  ptr::Weak<Node> leaf{root->left->left->left};
+  REQUIRE(Node::alive == (1 << 13) - 1);
+
+  pool.release(std::move(root));
+  pool.wait();
+  REQUIRE(Node::alive == 0);
+  REQUIRE(leaf.expired());
+  REQUIRE(Node::destroyers.count(std::this_thread::get_id()) == 0);
+
+  // Nothing is left to do, so this returns right away.
+  pool.wait();
+}
+
+TEST_CASE("teardown pools destroy a sole owner root on their own threads") {
+  Node::destroyers.clear();
+  ptr::TeardownPool pool(2);
+  ptr::Shared<Node> root(new Node);
+  root->left = tree(4);
+  pool.release(std::move(root));
+  pool.wait();
+  REQUIRE(Node::alive == 0);
+  REQUIRE(Node::destroyers.count(std::this_thread::get_id()) == 0);
+}
+
+TEST_CASE("teardown objects released elsewhere are destroyed inline") {
+  Node::destroyers.clear();
+  auto root = tree(3);
+  root.reset();
+  REQUIRE(Node::alive == 0);
+  REQUIRE(Node::destroyers == std::set<std::thread::id>{std::this_thread::get_id()});
+}
+
+TEST_CASE("teardown pools wait for outstanding work when destroyed") {
+  {
+    ptr::TeardownPool pool(2);
+    for (int i = 0; i < 10; ++i) {
+      pool.release(tree(6));
+    }
+    pool.release(ptr::Shared<Node>{});
+  }
+  REQUIRE(Node::alive == 0);
+}
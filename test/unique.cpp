@@ -0,0 +1,62 @@
+#include <catch.hpp>
+
+#include <ptr/unique.h>
+#include <ptr/weak.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Base {
+  static inline int alive = 0;
+
+  Base() { ++alive; }
+  virtual ~Base() { --alive; }
+};
+
+struct Derived : Base {
+  std::string name = "derived";
+};
+
+} // namespace
+
+TEST_CASE("unique objects are destroyed without being shared") {
+  {
+    auto owner = ptr::make_unique_shareable<Derived>();
+    REQUIRE(owner->name == "derived");
+    ptr::Unique<Derived> moved = std::move(owner);
+    REQUIRE(!owner);
+    REQUIRE(Base::alive == 1);
+
+    moved = ptr::make_unique_shareable<Derived>();
+    REQUIRE(Base::alive == 1);
+  }
+  REQUIRE(Base::alive == 0);
+
+  auto owner = ptr::make_unique_shareable<Derived>();
+  owner.reset();
+  REQUIRE(!owner);
+  REQUIRE(Base::alive == 0);
+}
+
+TEST_CASE("unique objects become shared in place") {
+  auto owner = ptr::make_unique_shareable<Derived>();
+  Derived *object = owner.get();
+
+  ptr::Shared<Base> shared(std::move(owner));
+  REQUIRE(!owner);
+  REQUIRE(shared.get() == object);
+  REQUIRE(shared.use_count() == 1);
+
+  ptr::Weak<Base> weak{shared};
+  std::vector<ptr::Shared<Base>> copies(3, shared);
+  REQUIRE(shared.use_count() == 4);
+  shared.reset();
+  copies.clear();
+  REQUIRE(weak.expired());
+  REQUIRE(Base::alive == 0);
+
+  ptr::Shared<Derived> empty(ptr::Unique<Derived>{});
+  REQUIRE(!empty.get());
+}
@@ -0,0 +1,84 @@
+#include <catch.hpp>
+
+#include <ptr/weak_cache.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("weak cache returns the live value for a key") {
+  ptr::WeakCache<int, std::string> cache;
+  int created = 0;
+  auto factory = [&]() {
+    ++created;
+    return std::string("value");
+  };
+
+  ptr::Shared<std::string> first = cache.get_or_create(1, factory);
+  ptr::Shared<std::string> second = cache.get_or_create(1, factory);
+  REQUIRE(created == 1);
+  REQUIRE(first.get() == second.get());
+  REQUIRE(cache.find(1).get() == first.get());
+  REQUIRE(cache.find(2).get() == nullptr);
+}
+
+TEST_CASE("weak cache purges entries when values die") {
+  ptr::WeakCache<int, std::string> cache;
+  {
+    auto value = cache.get_or_create(1, []() { return std::string("one"); });
+    ptr::Weak<std::string> observer{value};
+    REQUIRE(cache.size() == 1);
+  }
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.find(1).get() == nullptr);
+
+  int created = 0;
+  auto value = cache.get_or_create(1, [&]() {
+    ++created;
+    return std::string("uno");
+  });
+  REQUIRE(created == 1);
+  REQUIRE(*value == "uno");
+}
+
+TEST_CASE("weak cache values may outlive the cache") {
+  ptr::Shared<std::string> value;
+  {
+    ptr::WeakCache<int, std::string> cache(4);
+    value = cache.get_or_create(7, []() { return std::string("seven"); });
+  }
+  REQUIRE(*value == "seven");
+}
+
+TEST_CASE("weak cache forgets keys whose factory throws") {
+  ptr::WeakCache<int, std::string> cache;
+  REQUIRE_THROWS(cache.get_or_create(1, []() -> std::string { throw 42; }));
+  REQUIRE(cache.size() == 0);
+  auto value = cache.get_or_create(1, []() { return std::string("ok"); });
+  REQUIRE(*value == "ok");
+}
+
+TEST_CASE("weak cache deduplicates concurrent creators") {
+  ptr::WeakCache<int, int> cache;
+  std::atomic<int> created = 0;
+  std::vector<ptr::Shared<int>> results(8);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      results[i] = cache.get_or_create(3, [&]() {
+        ++created;
+        std::this_thread::yield();
+        return 3;
+      });
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(created == 1);
+  for (const ptr::Shared<int>& result : results) {
+    REQUIRE(result.get() == results[0].get());
+  }
+}